@@ -0,0 +1,3855 @@
+// ------------------------------------------------------
+// Biblioteca del árbol genealógico (implementación)
+// ------------------------------------------------------
+#include "arbol.h"
+#include <cstdio>     // snprintf
+#include <climits>    // INT_MIN, INT_MAX
+#include <csignal>    // signal (SIGPIPE al exportar con gzip)
+#include <cctype>     // isalnum, tolower
+#include <queue>      // priority_queue
+#ifndef _WIN32
+    #include <fcntl.h>      // open
+    #include <sys/mman.h>   // mmap / munmap
+    #include <sys/stat.h>   // fstat
+    #include <unistd.h>     // close, fsync
+#endif
+using namespace std;
+
+TipoArbol tipoArbol = ARBOL_GENEALOGICO;
+unordered_map<int, Persona*> indicePorID;
+
+// Texto que describe un estado (para mostrarlo o registrarlo)
+const char* mensajeEstado(EstadoArbol estado) {
+    switch (estado) {
+        case ESTADO_OK:            return "Operación realizada.";
+        case ESTADO_REEMPLAZADO:   return "Se reemplazó el subárbol existente.";
+        case ESTADO_NO_EXISTE:     return "No existe una persona con ese ID.";
+        case ESTADO_ID_DUPLICADO:  return "El ID ya existe en el árbol.";
+        case ESTADO_LADO_INVALIDO: return "Lado inválido. Use 'I' para izquierda o 'D' para derecha.";
+    }
+    return "Estado desconocido.";
+}
+
+// ---------------------
+// Utilidades
+// ---------------------
+
+// Reglas de validación compartidas por el ingreso manual y la importación
+bool edadValida(int edad) {
+    return edad >= 0 && edad <= 120;
+}
+
+bool generoValido(const string& genero) {
+    return genero == "Masculino" || genero == "Femenino" ||
+           genero == "masculino" || genero == "femenino";
+}
+
+// Código numérico del género: 0 = masculino, 1 = femenino, 2 = otro
+int codigoGenero(const string& genero) {
+    if (genero == "Masculino" || genero == "masculino") return 0;
+    if (genero == "Femenino" || genero == "femenino") return 1;
+    return 2;
+}
+
+// ---------------------
+// Pool de memoria para nodos
+// ---------------------
+
+PoolPersonas poolPersonas = { vector<BloquePool>(), NULL };
+
+// Obtiene memoria para una persona, reutilizando ranuras libres si las hay
+Persona* reservarPersona() {
+    RanuraPersona* ranura;
+
+    if (poolPersonas.libres != NULL) {
+        // Tomar la primera ranura de la lista libre
+        ranura = poolPersonas.libres;
+        poolPersonas.libres = ranura->siguienteLibre;
+    } else {
+        // Pedir un bloque nuevo solo cuando el actual se llenó
+        if (poolPersonas.bloques.empty() ||
+            poolPersonas.bloques.back().usadas == poolPersonas.bloques.back().capacidad) {
+            BloquePool nuevo = { new RanuraPersona[PERSONAS_POR_BLOQUE], PERSONAS_POR_BLOQUE, 0 };
+            poolPersonas.bloques.push_back(nuevo);
+        }
+        BloquePool& abierto = poolPersonas.bloques.back();
+        ranura = &abierto.ranuras[abierto.usadas++];
+    }
+
+    ranura->ocupada = true;
+    return new (ranura->memoria) Persona();   // Construir en la ranura
+}
+
+// Reserva n personas en un único bloque contiguo (para construcciones masivas).
+// El bloque se ubica antes del bloque abierto para no desperdiciar su resto.
+RanuraPersona* reservarPersonasContiguas(int n) {
+    BloquePool bloque = { new RanuraPersona[n > 0 ? n : 1], n, n };
+    for (int i = 0; i < n; i++) {
+        bloque.ranuras[i].ocupada = true;
+        new (bloque.ranuras[i].memoria) Persona();
+    }
+
+    if (poolPersonas.bloques.empty())
+        poolPersonas.bloques.push_back(bloque);
+    else
+        poolPersonas.bloques.insert(poolPersonas.bloques.end() - 1, bloque);
+    return bloque.ranuras;
+}
+
+// Persona construida dentro de una ranura
+Persona* personaDeRanura(RanuraPersona* ranura) {
+    return reinterpret_cast<Persona*>(ranura->memoria);
+}
+
+// Destruye una persona y devuelve su ranura a la lista libre
+void devolverPersona(Persona* p) {
+    RanuraPersona* ranura = reinterpret_cast<RanuraPersona*>(p);
+    p->~Persona();
+    ranura->ocupada = false;
+    ranura->siguienteLibre = poolPersonas.libres;
+    poolPersonas.libres = ranura;
+}
+
+// Libera de una vez todas las personas del pool: recorre los bloques en
+// orden de memoria (sin seguir punteros) y los devuelve al sistema
+void vaciarPool() {
+    for (size_t b = 0; b < poolPersonas.bloques.size(); b++) {
+        BloquePool& bloque = poolPersonas.bloques[b];
+
+        // Los string de cada persona viva aún deben destruirse
+        for (int i = 0; i < bloque.usadas; i++) {
+            if (bloque.ranuras[i].ocupada)
+                personaDeRanura(&bloque.ranuras[i])->~Persona();
+        }
+        delete[] bloque.ranuras;
+    }
+
+    poolPersonas.bloques.clear();
+    poolPersonas.libres = NULL;
+}
+
+// ---------------------
+// Funciones del Árbol
+// ---------------------
+
+// Carga los datos de una persona ya reservada y la registra en el índice
+void inicializarPersona(Persona* p, int id, string nombre, string apellido, int edad, 
+                        string fechaNac, string ocupacion, string genero) {
+    p->id = id;
+    p->nombre = nombre;
+    p->apellido = apellido;
+    p->edad = edad;
+    p->fechaNacimiento = fechaNac;
+    p->ocupacion = ocupacion;
+    p->genero = genero;
+    p->izq = NULL;   // Inicialmente no tiene hijos
+    p->der = NULL;
+    p->padre = NULL;
+
+    // Agregados de un nodo hoja
+    p->altura = 1;
+    p->tamano = 1;
+    p->sumaEdades = edad;
+    p->generos[0] = p->generos[1] = p->generos[2] = 0;
+    p->generos[codigoGenero(genero)] = 1;
+
+    // Registrar en el índice (si el ID ya existe se conserva el original)
+    if (indicePorID.find(id) == indicePorID.end())
+        indicePorID[id] = p;
+    indexarPersona(p);
+}
+
+// Crea una nueva persona en el pool de memoria y la retorna
+Persona* crearPersona(int id, string nombre, string apellido, int edad, 
+                      string fechaNac, string ocupacion, string genero) {
+    Persona* p = reservarPersona();
+    inicializarPersona(p, id, nombre, apellido, edad, fechaNac, ocupacion, genero);
+    return p;
+}
+
+// Libera una sola persona y la quita del índice de IDs
+void liberarPersona(Persona* p) {
+    olvidarPersonaGuardada(p);
+    unordered_map<int, Persona*>::iterator it = indicePorID.find(p->id);
+    if (it != indicePorID.end() && it->second == p)
+        indicePorID.erase(it);
+    desindexarPersona(p);
+    devolverPersona(p);
+}
+
+// Elimina el árbol completo de una sola vez vaciando el pool y el índice.
+// Solo debe usarse cuando raiz es el único árbol vivo en el programa.
+void limpiarArbolCompleto(Persona*& raiz) {
+    marcarArbolModificado();
+    indicePorID.clear();
+    if (indicesSecundarios.activos) {
+        indicesSecundarios = IndicesSecundarios();
+        activarIndicesSecundarios();
+    }
+    if (indiceNombres.activo) {
+        indiceNombres = IndiceNombres();
+        activarIndiceNombres();
+    }
+    vaciarPool();
+    raiz = NULL;
+}
+
+// ---------------------
+// Agregados por subárbol
+// ---------------------
+
+// Altura de un nodo (0 si es nulo)
+int alturaNodo(Persona* p) {
+    return (p == NULL) ? 0 : p->altura;
+}
+
+// Recalcula los agregados de un nodo a partir de los de sus hijos
+void actualizarAgregados(Persona* p) {
+    int altIzq = alturaNodo(p->izq);
+    int altDer = alturaNodo(p->der);
+    p->altura = 1 + (altIzq > altDer ? altIzq : altDer);
+
+    p->tamano = 1;
+    p->sumaEdades = p->edad;
+    p->generos[0] = p->generos[1] = p->generos[2] = 0;
+    p->generos[codigoGenero(p->genero)] = 1;
+
+    Persona* hijos[2] = { p->izq, p->der };
+    for (int h = 0; h < 2; h++) {
+        if (hijos[h] == NULL) continue;
+        p->tamano += hijos[h]->tamano;
+        p->sumaEdades += hijos[h]->sumaEdades;
+        for (int g = 0; g < 3; g++) p->generos[g] += hijos[h]->generos[g];
+    }
+}
+
+// Actualiza los agregados desde un nodo hasta la raíz: O(profundidad)
+void propagarAgregados(Persona* desde) {
+    for (Persona* p = desde; p != NULL; p = p->padre)
+        actualizarAgregados(p);
+}
+
+// Recalcula padres y agregados de todo el árbol (post-orden con pila).
+// Se usa cuando el árbol se armó enlazando nodos directamente.
+void recalcularAgregados(Persona* raiz) {
+    marcarArbolModificado();   // Para el guardado incremental: árbol rearmado
+
+    Pila<Persona*> pila;
+    Persona* actual = raiz;
+    Persona* ultimo = NULL;
+
+    while (actual != NULL || !pila.vacia()) {
+        while (actual != NULL) {
+            pila.apilar(actual);
+            actual = actual->izq;
+        }
+
+        Persona* cima = pila.elementos.back();
+        if (cima->der != NULL && cima->der != ultimo) {
+            actual = cima->der;
+            continue;
+        }
+
+        // Los dos hijos ya tienen sus agregados correctos
+        pila.desapilar();
+        if (cima->izq != NULL) cima->izq->padre = cima;
+        if (cima->der != NULL) cima->der->padre = cima;
+        actualizarAgregados(cima);
+        ultimo = cima;
+    }
+    if (raiz != NULL) raiz->padre = NULL;
+}
+
+// Busca a una persona por su ID usando el índice hash (tiempo constante)
+Persona* buscar(Persona* raiz, int id) {
+    if (raiz == NULL) return NULL;         // Árbol vacío
+
+    unordered_map<int, Persona*>::iterator it = indicePorID.find(id);
+    if (it == indicePorID.end()) return NULL;  // ID inexistente
+    return it->second;
+}
+
+// Inserta un hijo izquierdo o derecho según la letra indicada
+EstadoArbol insertarHijo(Persona* raiz, int idPadre, Persona* nuevoHijo, char lado) {
+    // Buscar al padre en el árbol
+    // (crearPersona ya registró al hijo en el índice: si idPadre es su propio
+    // ID, el padre no está en el árbol y enlazarlo formaría un ciclo)
+    Persona* padre = buscar(raiz, idPadre);
+    if (padre == NULL || padre == nuevoHijo) return ESTADO_NO_EXISTE;
+
+    // Lugar donde se engancha el hijo según el lado
+    Persona** hueco;
+    if (lado == 'I' || lado == 'i') hueco = &padre->izq;
+    else if (lado == 'D' || lado == 'd') hueco = &padre->der;
+    else return ESTADO_LADO_INVALIDO;
+
+    // Si el lado estaba ocupado se libera el subárbol reemplazado
+    EstadoArbol estado = ESTADO_OK;
+    if (*hueco != NULL) {
+        eliminarArbol(*hueco);
+        estado = ESTADO_REEMPLAZADO;
+    }
+
+    *hueco = nuevoHijo;
+    nuevoHijo->padre = padre;
+    propagarAgregados(padre);
+    marcarSubarbolModificado(padre);
+    return estado;
+}
+
+// Libera toda la memoria del árbol usando una pila explícita
+int eliminarArbol(Persona* raiz) {
+    if (raiz == NULL) return 0;
+
+    int liberadas = 0;
+    Pila<Persona*> pila;
+    pila.apilar(raiz);
+    while (!pila.vacia()) {
+        Persona* actual = pila.desapilar();
+
+        // Guardar los hijos antes de liberar el nodo actual
+        if (actual->izq != NULL) pila.apilar(actual->izq);
+        if (actual->der != NULL) pila.apilar(actual->der);
+
+        // Eliminar el nodo (y su entrada del índice)
+        liberarPersona(actual);
+        liberadas++;
+    }
+    return liberadas;
+}
+
+// Elimina una persona específica del árbol junto con todos sus descendientes
+Persona* eliminarPersona(Persona* raiz, int id, int* liberadas) {
+    if (liberadas != NULL) *liberadas = 0;
+    Persona* objetivo = buscar(raiz, id);
+    if (objetivo == NULL) return raiz;   // No existe: nada que hacer
+
+    // Si es la raíz se elimina el árbol completo
+    Persona* padre = objetivo->padre;
+    if (padre == NULL) {
+        int cantidad = eliminarArbol(objetivo);
+        if (liberadas != NULL) *liberadas = cantidad;
+        return NULL;
+    }
+
+    // Desconectar el subárbol de su padre, liberarlo y actualizar el camino
+    if (padre->izq == objetivo) padre->izq = NULL;
+    else padre->der = NULL;
+    marcarSubarbolModificado(padre);
+    int cantidad = eliminarArbol(objetivo);
+    if (liberadas != NULL) *liberadas = cantidad;
+    propagarAgregados(padre);
+
+    return raiz; // Retorna el árbol actualizado
+}
+
+vector<Persona*> ancestrosDe(Persona* p) {
+    vector<Persona*> ancestros;
+    if (p == NULL) return ancestros;
+    for (Persona* a = p->padre; a != NULL; a = a->padre) ancestros.push_back(a);
+    return ancestros;
+}
+
+int profundidadDe(Persona* p) {
+    int profundidad = 0;
+    for (; p != NULL && p->padre != NULL; p = p->padre) profundidad++;
+    return profundidad;
+}
+
+// ---------------------
+// Índices secundarios
+// ---------------------
+
+IndicesSecundarios indicesSecundarios;
+
+// Mantenimiento del índice de nombres (en su sección, más abajo)
+static void agregarNombres(Persona* p);
+static void quitarNombres(Persona* p);
+
+void indexarPersona(Persona* p) {
+    if (indiceNombres.activo) agregarNombres(p);
+
+    IndicesSecundarios& ix = indicesSecundarios;
+    if (!ix.activos) return;
+
+    ix.porApellido[p->apellido].insert(p);
+    ix.porOcupacion[p->ocupacion].insert(p);
+    ix.porEdad[p->edad].insert(p);
+
+    uint32_t pos = (uint32_t)ix.personas.size();
+    ix.personas.push_back(p);
+    ix.posicion[p] = pos;
+    if (pos / 64 >= ix.bitsGenero[0].size())
+        for (int g = 0; g < 3; g++) ix.bitsGenero[g].push_back(0);
+    ix.bitsGenero[codigoGenero(p->genero)][pos / 64] |= (uint64_t)1 << (pos % 64);
+}
+
+// Quita p del conjunto de la clave y borra la clave si queda vacía
+template <class Indice, class Clave>
+static void quitarDeIndice(Indice& indice, const Clave& clave, Persona* p) {
+    typename Indice::iterator it = indice.find(clave);
+    if (it == indice.end()) return;
+    it->second.erase(p);
+    if (it->second.empty()) indice.erase(it);
+}
+
+void desindexarPersona(Persona* p) {
+    if (indiceNombres.activo) quitarNombres(p);
+
+    IndicesSecundarios& ix = indicesSecundarios;
+    if (!ix.activos) return;
+
+    unordered_map<Persona*, uint32_t>::iterator it = ix.posicion.find(p);
+    if (it == ix.posicion.end()) return;
+    quitarDeIndice(ix.porApellido, p->apellido, p);
+    quitarDeIndice(ix.porOcupacion, p->ocupacion, p);
+    quitarDeIndice(ix.porEdad, p->edad, p);
+
+    // La última persona pasa a la posición que queda libre
+    uint32_t pos = it->second, ultima = (uint32_t)ix.personas.size() - 1;
+    ix.posicion.erase(it);
+    ix.bitsGenero[codigoGenero(p->genero)][pos / 64] &= ~((uint64_t)1 << (pos % 64));
+    if (pos != ultima) {
+        Persona* movida = ix.personas[ultima];
+        vector<uint64_t>& bits = ix.bitsGenero[codigoGenero(movida->genero)];
+        bits[ultima / 64] &= ~((uint64_t)1 << (ultima % 64));
+        bits[pos / 64] |= (uint64_t)1 << (pos % 64);
+        ix.personas[pos] = movida;
+        ix.posicion[movida] = pos;
+    }
+    ix.personas.pop_back();
+}
+
+void activarIndicesSecundarios() {
+    if (indicesSecundarios.activos) return;
+    indicesSecundarios.activos = true;
+
+    // Todas las personas vivas están en el índice de IDs (las de IDs
+    // repetidos se liberan enseguida al fallar su inserción)
+    indicesSecundarios.personas.reserve(indicePorID.size());
+    for (unordered_map<int, Persona*>::iterator it = indicePorID.begin(); it != indicePorID.end(); ++it)
+        indexarPersona(it->second);
+}
+
+// Copia un conjunto del índice (o nada si la clave no existe)
+template <class Indice, class Clave>
+static vector<Persona*> personasDeClave(const Indice& indice, const Clave& clave) {
+    typename Indice::const_iterator it = indice.find(clave);
+    if (it == indice.end()) return vector<Persona*>();
+    return vector<Persona*>(it->second.begin(), it->second.end());
+}
+
+vector<Persona*> buscarPorApellido(const string& apellido) {
+    activarIndicesSecundarios();
+    return personasDeClave(indicesSecundarios.porApellido, apellido);
+}
+
+vector<Persona*> buscarPorOcupacion(const string& ocupacion) {
+    activarIndicesSecundarios();
+    return personasDeClave(indicesSecundarios.porOcupacion, ocupacion);
+}
+
+vector<Persona*> buscarPorGenero(const string& genero) {
+    activarIndicesSecundarios();
+    const IndicesSecundarios& ix = indicesSecundarios;
+    const vector<uint64_t>& bits = ix.bitsGenero[codigoGenero(genero)];
+
+    // Solo se miran las palabras con algún bit encendido
+    vector<Persona*> resultado;
+    for (size_t w = 0; w < bits.size(); w++) {
+        for (uint64_t resto = bits[w]; resto != 0; resto &= resto - 1) {
+#ifdef __GNUC__
+            int bit = __builtin_ctzll(resto);
+#else
+            int bit = 0;
+            while (((resto >> bit) & 1) == 0) bit++;
+#endif
+            resultado.push_back(ix.personas[w * 64 + bit]);
+        }
+    }
+    return resultado;
+}
+
+vector<Persona*> buscarPorEdad(int edadMinima, int edadMaxima) {
+    activarIndicesSecundarios();
+    const map<int, unordered_set<Persona*> >& porEdad = indicesSecundarios.porEdad;
+
+    vector<Persona*> resultado;
+    map<int, unordered_set<Persona*> >::const_iterator it = porEdad.lower_bound(edadMinima);
+    for (; it != porEdad.end() && it->first <= edadMaxima; ++it)
+        resultado.insert(resultado.end(), it->second.begin(), it->second.end());
+    return resultado;
+}
+
+// ---------------------
+// Búsqueda por nombre (prefijos y parecidos)
+// ---------------------
+
+IndiceNombres indiceNombres;
+
+// Coeficiente de Dice mínimo para considerar parecidas dos palabras
+const double UMBRAL_PARECIDO = 0.4;
+
+// Personas que se puntúan por cada resultado pedido en la búsqueda de parecidos
+const size_t CANDIDATOS_POR_RESULTADO = 8;
+
+// Letra base de cada carácter Latin-1 desde 0xC0 hasta 0xFF (mayúsculas y
+// después minúsculas); los signos de multiplicar y dividir son separadores
+static const char LETRA_BASE_LATIN1[] =
+    "aaaaaaaceeeeiiiidnooooo ouuuuyts"
+    "aaaaaaaceeeeiiiidnooooo ouuuuyty";
+
+string plegarTexto(const string& texto) {
+    string plegado;
+    plegado.reserve(texto.size());
+    for (size_t i = 0; i < texto.size(); i++) {
+        unsigned char c = (unsigned char)texto[i];
+        unsigned codigo = c;
+
+        // Secuencia UTF-8 completa: se decodifica. Si no, el byte es un
+        // carácter de Windows-1252 (igual a Latin-1 en las letras acentuadas).
+        int continuacion = (c >= 0xC2 && c <= 0xDF) ? 1 : (c >= 0xE0 && c <= 0xEF) ? 2
+                         : (c >= 0xF0 && c <= 0xF4) ? 3 : 0;
+        if (continuacion > 0 && i + continuacion < texto.size()) {
+            bool valida = true;
+            for (int k = 1; k <= continuacion; k++)
+                valida = valida && ((unsigned char)texto[i + k] & 0xC0) == 0x80;
+            if (valida) {
+                codigo = c & (0x3F >> continuacion);
+                for (int k = 1; k <= continuacion; k++)
+                    codigo = (codigo << 6) | ((unsigned char)texto[i + k] & 0x3F);
+                i += continuacion;
+            }
+        }
+
+        char letra = ' ';
+        if (codigo < 0x80 && isalnum((int)codigo)) letra = (char)tolower((int)codigo);
+        else if (codigo >= 0xC0 && codigo <= 0xFF) letra = LETRA_BASE_LATIN1[codigo - 0xC0];
+
+        // Un solo espacio entre palabras y ninguno al principio
+        if (letra == ' ' && (plegado.empty() || plegado[plegado.size() - 1] == ' ')) continue;
+        plegado += letra;
+    }
+    if (!plegado.empty() && plegado[plegado.size() - 1] == ' ') plegado.erase(plegado.size() - 1);
+    return plegado;
+}
+
+// Palabras distintas de un texto ya plegado
+static vector<string> separarPalabras(const string& plegado) {
+    vector<string> palabras;
+    size_t inicio = 0;
+    while (inicio < plegado.size()) {
+        size_t fin = plegado.find(' ', inicio);
+        if (fin == string::npos) fin = plegado.size();
+        string palabra = plegado.substr(inicio, fin - inicio);
+        if (find(palabras.begin(), palabras.end(), palabra) == palabras.end())
+            palabras.push_back(palabra);
+        inicio = fin + 1;
+    }
+    return palabras;
+}
+
+static vector<string> palabrasDePersona(const Persona* p) {
+    return separarPalabras(plegarTexto(p->nombre + " " + p->apellido));
+}
+
+// Trigramas distintos de " palabra " (un espacio en cada extremo marca
+// el principio y el final)
+static vector<uint32_t> trigramasDe(const string& palabra) {
+    string t = " " + palabra + " ";
+    vector<uint32_t> trigramas;
+    for (size_t i = 0; i + 3 <= t.size(); i++) {
+        uint32_t g = ((uint32_t)(unsigned char)t[i] << 16) |
+                     ((uint32_t)(unsigned char)t[i + 1] << 8) | (unsigned char)t[i + 2];
+        if (find(trigramas.begin(), trigramas.end(), g) == trigramas.end())
+            trigramas.push_back(g);
+    }
+    return trigramas;
+}
+
+static int nuevoNodoTrie(IndiceNombres& ix, const string& tramo, int padre) {
+    NodoTrie n;
+    n.tramo = tramo;
+    n.padre = padre;
+    n.palabra = -1;
+    n.personas = 0;
+    ix.trie.push_back(n);
+    return (int)ix.trie.size() - 1;
+}
+
+static int hijoTrie(const NodoTrie& n, char c) {
+    for (size_t h = 0; h < n.hijos.size(); h++)
+        if (n.hijos[h].first == c) return n.hijos[h].second;
+    return -1;
+}
+
+// Agrega la palabra al trie y devuelve el nodo donde termina
+static int insertarEnTrie(IndiceNombres& ix, const string& palabra) {
+    int nodo = 0;
+    size_t i = 0;
+    while (i < palabra.size()) {
+        int hijo = hijoTrie(ix.trie[nodo], palabra[i]);
+        if (hijo < 0) {
+            int hoja = nuevoNodoTrie(ix, palabra.substr(i), nodo);
+            ix.trie[nodo].hijos.push_back(make_pair(palabra[i], hoja));
+            return hoja;
+        }
+
+        // Parte en común entre el tramo del hijo y lo que falta de la palabra
+        string tramo = ix.trie[hijo].tramo;
+        size_t comun = 0;
+        while (comun < tramo.size() && i + comun < palabra.size() && tramo[comun] == palabra[i + comun])
+            comun++;
+
+        // La palabra se separa a mitad del tramo: nodo -> medio -> hijo
+        if (comun < tramo.size()) {
+            int medio = nuevoNodoTrie(ix, tramo.substr(0, comun), nodo);
+            ix.trie[medio].personas = ix.trie[hijo].personas;
+            ix.trie[medio].hijos.push_back(make_pair(tramo[comun], hijo));
+            ix.trie[hijo].tramo = tramo.substr(comun);
+            ix.trie[hijo].padre = medio;
+            vector<pair<char, int> >& hijos = ix.trie[nodo].hijos;
+            for (size_t h = 0; h < hijos.size(); h++)
+                if (hijos[h].second == hijo) hijos[h].second = medio;
+            hijo = medio;
+        }
+        nodo = hijo;
+        i += comun;
+    }
+    return nodo;
+}
+
+// Número de la palabra en el vocabulario (la agrega si es nueva). Las
+// palabras que se quedan sin personas no se borran: se saltean al buscar.
+static int idDePalabra(IndiceNombres& ix, const string& palabra) {
+    unordered_map<string, int>::iterator it = ix.idDePalabra.find(palabra);
+    if (it != ix.idDePalabra.end()) return it->second;
+
+    int id = (int)ix.palabras.size();
+    ix.idDePalabra[palabra] = id;
+    ix.palabras.push_back(palabra);
+    int nodo = insertarEnTrie(ix, palabra);
+    ix.trie[nodo].palabra = id;
+    ix.nodoDePalabra.push_back(nodo);
+    ix.personasDePalabra.push_back(unordered_set<Persona*>());
+
+    vector<uint32_t> trigramas = trigramasDe(palabra);
+    ix.trigramasDePalabra.push_back((int)trigramas.size());
+    for (size_t g = 0; g < trigramas.size(); g++)
+        ix.palabrasDeTrigrama[trigramas[g]].push_back(id);
+    return id;
+}
+
+// Suma delta a las personas de un nodo y de todos sus ancestros
+static void sumarPersonasTrie(IndiceNombres& ix, int nodo, int delta) {
+    for (; nodo >= 0; nodo = ix.trie[nodo].padre) ix.trie[nodo].personas += delta;
+}
+
+static void agregarNombres(Persona* p) {
+    IndiceNombres& ix = indiceNombres;
+    vector<string> palabras = palabrasDePersona(p);
+    for (size_t i = 0; i < palabras.size(); i++) {
+        int id = idDePalabra(ix, palabras[i]);
+        if (ix.personasDePalabra[id].insert(p).second)
+            sumarPersonasTrie(ix, ix.nodoDePalabra[id], 1);
+    }
+}
+
+static void quitarNombres(Persona* p) {
+    IndiceNombres& ix = indiceNombres;
+    vector<string> palabras = palabrasDePersona(p);
+    for (size_t i = 0; i < palabras.size(); i++) {
+        unordered_map<string, int>::iterator it = ix.idDePalabra.find(palabras[i]);
+        if (it != ix.idDePalabra.end() && ix.personasDePalabra[it->second].erase(p) > 0)
+            sumarPersonasTrie(ix, ix.nodoDePalabra[it->second], -1);
+    }
+}
+
+void activarIndiceNombres() {
+    if (indiceNombres.activo) return;
+    indiceNombres.activo = true;
+    nuevoNodoTrie(indiceNombres, "", -1);   // Raíz
+    for (unordered_map<int, Persona*>::iterator it = indicePorID.begin(); it != indicePorID.end(); ++it)
+        agregarNombres(it->second);
+}
+
+// Nodo donde termina el prefijo, o el primero cuyo tramo lo completa
+// (-1 si ninguna palabra empieza así)
+static int nodoDePrefijo(const IndiceNombres& ix, const string& prefijo) {
+    int nodo = 0;
+    size_t i = 0;
+    while (i < prefijo.size()) {
+        int hijo = hijoTrie(ix.trie[nodo], prefijo[i]);
+        if (hijo < 0) return -1;
+        const string& tramo = ix.trie[hijo].tramo;
+        size_t largo = min(tramo.size(), prefijo.size() - i);
+        if (tramo.compare(0, largo, prefijo, i, largo) != 0) return -1;
+        nodo = hijo;
+        i += largo;
+    }
+    return nodo;
+}
+
+// Largo del texto desde la raíz del trie hasta el nodo
+static size_t largoHastaNodo(const IndiceNombres& ix, int nodo) {
+    size_t largo = 0;
+    for (; nodo > 0; nodo = ix.trie[nodo].padre) largo += ix.trie[nodo].tramo.size();
+    return largo;
+}
+
+// true si cada prefijo (salvo el indicado) empieza alguna palabra de p
+static bool cumplePrefijos(const Persona* p, const vector<string>& prefijos, size_t salvo) {
+    vector<string> suyas = palabrasDePersona(p);
+    for (size_t i = 0; i < prefijos.size(); i++) {
+        if (i == salvo) continue;
+        bool alguna = false;
+        for (size_t j = 0; j < suyas.size() && !alguna; j++)
+            alguna = suyas[j].compare(0, prefijos[i].size(), prefijos[i]) == 0;
+        if (!alguna) return false;
+    }
+    return true;
+}
+
+vector<Persona*> buscarNombresPorPrefijo(const string& consulta, int k) {
+    activarIndiceNombres();
+    const IndiceNombres& ix = indiceNombres;
+    vector<Persona*> resultado;
+    vector<string> prefijos = separarPalabras(plegarTexto(consulta));
+    if (prefijos.empty() || k <= 0) return resultado;
+
+    // Se recorre el subárbol del prefijo con menos personas; los demás
+    // prefijos solo filtran a las que aparecen
+    int inicio = -1;
+    size_t elegido = 0;
+    for (size_t i = 0; i < prefijos.size(); i++) {
+        int nodo = nodoDePrefijo(ix, prefijos[i]);
+        if (nodo < 0 || ix.trie[nodo].personas == 0) return resultado;
+        if (inicio < 0 || ix.trie[nodo].personas < ix.trie[inicio].personas) {
+            inicio = nodo;
+            elegido = i;
+        }
+    }
+
+    // Nodos por largo de palabra creciente: las exactas salen primero
+    typedef pair<size_t, int> NodoPendiente;   // (largo hasta el nodo, nodo)
+    priority_queue<NodoPendiente, vector<NodoPendiente>, greater<NodoPendiente> > cola;
+    cola.push(NodoPendiente(largoHastaNodo(ix, inicio), inicio));
+    unordered_set<Persona*> vistas;
+
+    while (!cola.empty() && resultado.size() < (size_t)k) {
+        NodoPendiente actual = cola.top();
+        cola.pop();
+        const NodoTrie& n = ix.trie[actual.second];
+
+        if (n.palabra >= 0) {
+            const unordered_set<Persona*>& personas = ix.personasDePalabra[n.palabra];
+            for (unordered_set<Persona*>::const_iterator it = personas.begin();
+                 it != personas.end() && resultado.size() < (size_t)k; ++it) {
+                if (!vistas.insert(*it).second) continue;
+                if (prefijos.size() > 1 && !cumplePrefijos(*it, prefijos, elegido)) continue;
+                resultado.push_back(*it);
+            }
+        }
+        for (size_t h = 0; h < n.hijos.size(); h++) {
+            const NodoTrie& hijo = ix.trie[n.hijos[h].second];
+            if (hijo.personas > 0)
+                cola.push(NodoPendiente(actual.first + hijo.tramo.size(), n.hijos[h].second));
+        }
+    }
+    return resultado;
+}
+
+// Palabras del vocabulario parecidas a una de la consulta, de mayor a menor
+// coeficiente de Dice: 2 * trigramas en común / (trigramas de una + de otra)
+static vector<pair<double, int> > palabrasParecidas(const IndiceNombres& ix, const string& palabra) {
+    vector<uint32_t> trigramas = trigramasDe(palabra);
+    unordered_map<int, int> comunes;
+    for (size_t g = 0; g < trigramas.size(); g++) {
+        unordered_map<uint32_t, vector<int> >::const_iterator it = ix.palabrasDeTrigrama.find(trigramas[g]);
+        if (it == ix.palabrasDeTrigrama.end()) continue;
+        for (size_t w = 0; w < it->second.size(); w++) comunes[it->second[w]]++;
+    }
+
+    vector<pair<double, int> > parecidas;
+    for (unordered_map<int, int>::iterator it = comunes.begin(); it != comunes.end(); ++it) {
+        if (ix.personasDePalabra[it->first].empty()) continue;
+        double dice = 2.0 * it->second / (trigramas.size() + ix.trigramasDePalabra[it->first]);
+        if (dice >= UMBRAL_PARECIDO) parecidas.push_back(make_pair(dice, it->first));
+    }
+    sort(parecidas.begin(), parecidas.end(), greater<pair<double, int> >());
+    return parecidas;
+}
+
+// Mayor puntaje primero; a igual puntaje, menor ID
+static bool compararCoincidencias(const CoincidenciaNombre& a, const CoincidenciaNombre& b) {
+    if (a.puntaje != b.puntaje) return a.puntaje > b.puntaje;
+    return a.persona->id < b.persona->id;
+}
+
+vector<CoincidenciaNombre> buscarNombresParecidos(const string& consulta, int k) {
+    activarIndiceNombres();
+    const IndiceNombres& ix = indiceNombres;
+    vector<CoincidenciaNombre> candidatas;
+    vector<string> palabras = separarPalabras(plegarTexto(consulta));
+    if (palabras.empty() || k <= 0) return candidatas;
+
+    // Palabras parecidas (y su puntaje) para cada palabra de la consulta
+    vector<vector<pair<double, int> > > parecidas(palabras.size());
+    vector<unordered_map<int, double> > puntajeDe(palabras.size());
+    for (size_t i = 0; i < palabras.size(); i++) {
+        parecidas[i] = palabrasParecidas(ix, palabras[i]);
+        for (size_t w = 0; w < parecidas[i].size(); w++)
+            puntajeDe[i][parecidas[i][w].second] = parecidas[i][w].first;
+    }
+
+    // Candidatas: las personas de las palabras más parecidas, alternando
+    // entre las palabras de la consulta, hasta juntar las suficientes
+    size_t limite = (size_t)k * CANDIDATOS_POR_RESULTADO;
+    unordered_set<Persona*> vistas;
+    for (size_t rango = 0; candidatas.size() < limite; rango++) {
+        bool quedan = false;
+        for (size_t i = 0; i < palabras.size() && candidatas.size() < limite; i++) {
+            if (rango >= parecidas[i].size()) continue;
+            quedan = true;
+
+            const unordered_set<Persona*>& personas = ix.personasDePalabra[parecidas[i][rango].second];
+            for (unordered_set<Persona*>::const_iterator it = personas.begin();
+                 it != personas.end() && candidatas.size() < limite; ++it) {
+                if (!vistas.insert(*it).second) continue;
+
+                // Cada palabra de la consulta aporta su mejor parecido en la persona
+                vector<string> suyas = palabrasDePersona(*it);
+                double puntaje = 0;
+                for (size_t j = 0; j < palabras.size(); j++) {
+                    double mejor = 0;
+                    for (size_t s = 0; s < suyas.size(); s++) {
+                        unordered_map<int, double>::const_iterator p =
+                            puntajeDe[j].find(ix.idDePalabra.find(suyas[s])->second);
+                        if (p != puntajeDe[j].end() && p->second > mejor) mejor = p->second;
+                    }
+                    puntaje += mejor;
+                }
+                CoincidenciaNombre c = { *it, puntaje / palabras.size() };
+                candidatas.push_back(c);
+            }
+        }
+        if (!quedan) break;
+    }
+
+    sort(candidatas.begin(), candidatas.end(), compararCoincidencias);
+    if (candidatas.size() > (size_t)k) candidatas.resize(k);
+    return candidatas;
+}
+
+// ---------------------
+// Parentesco (ancestro común más cercano)
+// ---------------------
+
+TablaParentesco tablaParentesco;
+
+// Las consultas de parentesco pueden armar la tabla aunque solo lean el
+// árbol: el cerrojo evita que dos lectores la armen a la vez o que uno la
+// rearme (para otra raíz) mientras otro la está leyendo
+static mutex cerrojoParentesco;
+
+void invalidarParentesco() {
+    lock_guard<mutex> bloqueo(cerrojoParentesco);
+    tablaParentesco.valida = false;
+}
+
+// Arma el preorden, las profundidades y la tabla de mínimos del árbol
+static void armarTablaParentesco(Persona* raiz) {
+    TablaParentesco& t = tablaParentesco;
+    t = TablaParentesco();
+    t.valida = true;
+    t.raiz = raiz;
+    if (raiz == NULL) return;
+
+    size_t n = raiz->tamano;
+    t.posicion.reserve(n);
+    t.orden.reserve(n);
+    t.padre.reserve(n);
+    t.profundidad.reserve(n);
+
+    // Preorden con pila explícita: (persona, posición de su padre)
+    vector<pair<Persona*, int> > pila;
+    pila.push_back(make_pair(raiz, -1));
+    while (!pila.empty()) {
+        Persona* p = pila.back().first;
+        int padre = pila.back().second;
+        pila.pop_back();
+
+        int posicion = (int)t.orden.size();
+        t.posicion[p] = posicion;
+        t.orden.push_back(p);
+        t.padre.push_back(padre);
+        t.profundidad.push_back(padre < 0 ? 0 : t.profundidad[padre] + 1);
+        if (p->der) pila.push_back(make_pair(p->der, posicion));
+        if (p->izq) pila.push_back(make_pair(p->izq, posicion));
+    }
+
+    // Cada nivel combina dos tramos del nivel anterior
+    n = t.orden.size();
+    t.minimo.push_back(vector<int>(n));
+    for (size_t i = 0; i < n; i++) t.minimo[0][i] = (int)i;
+    for (size_t j = 1; ((size_t)1 << j) <= n; j++) {
+        size_t mitad = (size_t)1 << (j - 1);
+        vector<int> nivel(n - 2 * mitad + 1);
+        const vector<int>& previo = t.minimo[j - 1];
+        for (size_t i = 0; i < nivel.size(); i++) {
+            int a = previo[i], b = previo[i + mitad];
+            nivel[i] = (t.profundidad[a] <= t.profundidad[b]) ? a : b;
+        }
+        t.minimo.push_back(vector<int>());
+        t.minimo.back().swap(nivel);
+    }
+}
+
+// Posición menos profunda entre desde y hasta (inclusive) en O(1)
+static int posicionMenosProfunda(const TablaParentesco& t, int desde, int hasta) {
+    unsigned largo = (unsigned)(hasta - desde + 1);
+#ifdef __GNUC__
+    int j = 31 - __builtin_clz(largo);
+#else
+    int j = 0;
+    while ((2u << j) <= largo) j++;
+#endif
+    int a = t.minimo[j][desde], b = t.minimo[j][hasta - (1 << j) + 1];
+    return (t.profundidad[a] <= t.profundidad[b]) ? a : b;
+}
+
+void activarParentesco(Persona* raiz) {
+    lock_guard<mutex> bloqueo(cerrojoParentesco);
+    if (!tablaParentesco.valida || tablaParentesco.raiz != raiz) armarTablaParentesco(raiz);
+}
+
+// Posiciones de a y b en la tabla (armada para raiz); false si alguna falta.
+// Se llama con cerrojoParentesco tomado.
+static bool posicionesParentesco(Persona* raiz, Persona* a, Persona* b, int& pa, int& pb) {
+    TablaParentesco& t = tablaParentesco;
+    if (!t.valida || t.raiz != raiz) armarTablaParentesco(raiz);
+
+    unordered_map<Persona*, int>::iterator ia = t.posicion.find(a);
+    unordered_map<Persona*, int>::iterator ib = t.posicion.find(b);
+    if (ia == t.posicion.end() || ib == t.posicion.end()) return false;
+    pa = ia->second;
+    pb = ib->second;
+    return true;
+}
+
+// Posición del ancestro común: el padre de la menos profunda del tramo
+// (a, b] del preorden, salvo que una sea ancestro de la otra
+static int posicionAncestroComun(const TablaParentesco& t, int a, int b) {
+    if (a == b) return a;
+    if (a > b) swap(a, b);
+    return t.padre[posicionMenosProfunda(t, a + 1, b)];
+}
+
+Persona* ancestroComun(Persona* raiz, Persona* a, Persona* b) {
+    lock_guard<mutex> bloqueo(cerrojoParentesco);
+    int pa, pb;
+    if (!posicionesParentesco(raiz, a, b, pa, pb)) return NULL;
+    return tablaParentesco.orden[posicionAncestroComun(tablaParentesco, pa, pb)];
+}
+
+// Forma masculina o femenina según el género de p (las dos si es "Otro")
+static string segunGenero(const Persona* p, const string& masculino, const string& femenino) {
+    int genero = codigoGenero(p->genero);
+    if (genero == 0) return masculino;
+    if (genero == 1) return femenino;
+    return masculino + "/" + femenino;
+}
+
+// Nombres de los ancestros directos por generación (1 = padre)
+static const char* const ANCESTROS[][2] = {
+    { "padre", "madre" }, { "abuelo", "abuela" }, { "bisabuelo", "bisabuela" },
+    { "tatarabuelo", "tatarabuela" }, { "trastatarabuelo", "trastatarabuela" }
+};
+
+// Nombres de los descendientes directos por generación (1 = hijo)
+static const char* const DESCENDIENTES[][2] = {
+    { "hijo", "hija" }, { "nieto", "nieta" }, { "bisnieto", "bisnieta" },
+    { "tataranieto", "tataranieta" }, { "trastataranieto", "trastataranieta" }
+};
+
+// Grado de los primos (1 = primo hermano)
+static const char* GRADOS_PRIMO[][2] = {
+    { "hermano", "hermana" }, { "segundo", "segunda" }, { "tercero", "tercera" },
+    { "cuarto", "cuarta" }, { "quinto", "quinta" }
+};
+
+const int GENERACIONES_CON_NOMBRE = 5;
+
+// Qué es a de b, sabiendo a cuántas generaciones está cada uno del
+// ancestro común (ga para a, gb para b)
+static string etiquetaParentesco(const Persona* a, int ga, int gb) {
+    if (ga == 0 && gb == 0) return "misma persona";
+
+    // Línea directa
+    if (ga == 0) {
+        if (gb <= GENERACIONES_CON_NOMBRE) return segunGenero(a, ANCESTROS[gb - 1][0], ANCESTROS[gb - 1][1]);
+        return segunGenero(a, "ancestro", "ancestra") + " de " + to_string(gb) + " generaciones";
+    }
+    if (gb == 0) {
+        if (ga <= GENERACIONES_CON_NOMBRE) return segunGenero(a, DESCENDIENTES[ga - 1][0], DESCENDIENTES[ga - 1][1]);
+        return "descendiente de " + to_string(ga) + " generaciones";
+    }
+
+    // a cuelga de un hermano de un ancestro de b (o al revés)
+    if (ga == 1 && gb == 1) return segunGenero(a, "hermano", "hermana");
+    if (ga == 1) {
+        if (gb == 2) return segunGenero(a, "tío", "tía");
+        if (gb - 1 <= GENERACIONES_CON_NOMBRE)   // Hermano del abuelo de b: tío abuelo
+            return segunGenero(a, string("tío ") + ANCESTROS[gb - 2][0], string("tía ") + ANCESTROS[gb - 2][1]);
+        return segunGenero(a, "tío", "tía") + " de " + to_string(gb - 1) + " generaciones";
+    }
+    if (gb == 1) {
+        if (ga == 2) return segunGenero(a, "sobrino", "sobrina");
+        if (ga - 1 <= GENERACIONES_CON_NOMBRE)   // Nieto de un hermano de b: sobrino nieto
+            return segunGenero(a, string("sobrino ") + DESCENDIENTES[ga - 2][0],
+                               string("sobrina ") + DESCENDIENTES[ga - 2][1]);
+        return segunGenero(a, "sobrino", "sobrina") + " de " + to_string(ga - 1) + " generaciones";
+    }
+
+    // Primos: el grado lo da la rama más corta y la diferencia se aclara
+    int grado = min(ga, gb) - 1;
+    string etiqueta = (grado <= GENERACIONES_CON_NOMBRE)
+        ? segunGenero(a, string("primo ") + GRADOS_PRIMO[grado - 1][0], string("prima ") + GRADOS_PRIMO[grado - 1][1])
+        : segunGenero(a, "primo", "prima") + " en grado " + to_string(grado);
+    int diferencia = abs(ga - gb);
+    if (diferencia > 0)
+        etiqueta += " (" + to_string(diferencia) + (diferencia == 1 ? " generación " : " generaciones ")
+                  + (ga < gb ? "más arriba)" : "más abajo)");
+    return etiqueta;
+}
+
+Parentesco calcularParentesco(Persona* raiz, Persona* a, Persona* b) {
+    Parentesco resultado;
+    resultado.ancestroComun = NULL;
+    resultado.generacionesA = resultado.generacionesB = 0;
+
+    {
+        lock_guard<mutex> bloqueo(cerrojoParentesco);
+        int pa, pb;
+        if (!posicionesParentesco(raiz, a, b, pa, pb)) {
+            resultado.etiqueta = "sin parentesco en este árbol";
+            return resultado;
+        }
+        const TablaParentesco& t = tablaParentesco;
+        int comun = posicionAncestroComun(t, pa, pb);
+        resultado.ancestroComun = t.orden[comun];
+        resultado.generacionesA = t.profundidad[pa] - t.profundidad[comun];
+        resultado.generacionesB = t.profundidad[pb] - t.profundidad[comun];
+    }
+
+    // La etiqueta solo usa el género de a: se arma fuera del cerrojo
+    resultado.etiqueta = etiquetaParentesco(a, resultado.generacionesA, resultado.generacionesB);
+    return resultado;
+}
+
+// ---------------------
+// Almacenamiento por arreglos paralelos (SoA)
+// ---------------------
+
+// Agrega una persona sin enlazar y devuelve su índice (o SOA_NINGUNO si el ID existe)
+uint32_t crearPersonaSoA(ArbolSoA& a, int id, string nombre, string apellido, int edad,
+                         string fechaNac, string ocupacion, string genero) {
+    if (a.indice.find(id) != a.indice.end()) return SOA_NINGUNO;
+
+    uint32_t n = (uint32_t)a.ids.size();
+    a.ids.push_back(id);
+    a.edades.push_back(edad);
+    a.generos.push_back((uint8_t)codigoGenero(genero));
+    a.hijosIzq.push_back(SOA_NINGUNO);
+    a.hijosDer.push_back(SOA_NINGUNO);
+    a.nombres.push_back(nombre);
+    a.apellidos.push_back(apellido);
+    a.fechas.push_back(fechaNac);
+    a.ocupaciones.push_back(ocupacion);
+    a.textosGenero.push_back(genero);
+    a.indice[id] = n;
+    return n;
+}
+
+// Busca el índice de una persona por ID
+uint32_t buscarSoA(const ArbolSoA& a, int id) {
+    unordered_map<int, uint32_t>::const_iterator it = a.indice.find(id);
+    return (it == a.indice.end()) ? SOA_NINGUNO : it->second;
+}
+
+// Enlaza un hijo ya creado bajo el padre indicado (lado 'I' o 'D')
+bool insertarHijoSoA(ArbolSoA& a, int idPadre, uint32_t hijo, char lado) {
+    uint32_t padre = buscarSoA(a, idPadre);
+    if (padre == SOA_NINGUNO || hijo == SOA_NINGUNO) return false;
+
+    if (lado == 'I' || lado == 'i') a.hijosIzq[padre] = hijo;
+    else if (lado == 'D' || lado == 'd') a.hijosDer[padre] = hijo;
+    else return false;
+    return true;
+}
+
+// Copia un árbol de punteros a una estructura SoA (pre-orden con pila),
+// de modo que los nodos cercanos en el recorrido quedan cercanos en memoria
+void convertirASoA(Persona* raiz, ArbolSoA& a) {
+    a = ArbolSoA();
+    if (raiz == NULL) return;
+
+    // Cada marco recuerda el padre y de qué lado cuelga el nodo
+    struct Marco {
+        Persona* persona;
+        uint32_t padre;
+        bool esIzq;
+    };
+    Pila<Marco> pila;
+    Marco inicio = { raiz, SOA_NINGUNO, false };
+    pila.apilar(inicio);
+
+    while (!pila.vacia()) {
+        Marco m = pila.desapilar();
+        Persona* p = m.persona;
+        uint32_t n = crearPersonaSoA(a, p->id, p->nombre, p->apellido, p->edad,
+                                     p->fechaNacimiento, p->ocupacion, p->genero);
+
+        // Los vectores pueden moverse al crecer: se enlaza por índice
+        if (m.padre == SOA_NINGUNO) a.r = n;
+        else if (m.esIzq) a.hijosIzq[m.padre] = n;
+        else a.hijosDer[m.padre] = n;
+
+        if (p->der != NULL) { Marco d = { p->der, n, false }; pila.apilar(d); }
+        if (p->izq != NULL) { Marco i = { p->izq, n, true };  pila.apilar(i); }
+    }
+}
+
+// ---------------------
+// Recorridos genéricos
+// ---------------------
+
+// Inserta una persona en un Árbol Binario de Búsqueda (ABB) según su ID
+// (de forma iterativa para no desbordar la pila en árboles degenerados)
+Persona* insertarABB(Persona* raiz, Persona* nueva, EstadoArbol* estado) {
+    if (estado != NULL) *estado = ESTADO_OK;
+
+    // Si el árbol está vacío, la nueva persona se convierte en la raíz
+    if (raiz == NULL) return nueva;
+
+    Persona* actual = raiz;
+    while (true) {
+        // Si el ID es menor, bajar por el subárbol izquierdo
+        if (nueva->id < actual->id) {
+            if (actual->izq == NULL) { actual->izq = nueva; nueva->padre = actual; break; }
+            actual = actual->izq;
+        }
+        // Si el ID es mayor, bajar por el subárbol derecho
+        else if (nueva->id > actual->id) {
+            if (actual->der == NULL) { actual->der = nueva; nueva->padre = actual; break; }
+            actual = actual->der;
+        }
+        // Si el ID ya existe, se descarta la inserción
+        else {
+            if (estado != NULL) *estado = ESTADO_ID_DUPLICADO;
+            liberarPersona(nueva); // Se elimina para evitar fugas de memoria
+            return raiz;
+        }
+    }
+
+    propagarAgregados(nueva->padre);
+    marcarSubarbolModificado(nueva->padre);
+    return raiz; // Se retorna la raíz actual del ABB
+}
+
+// Busca por ID aprovechando el orden del ABB/AVL: O(altura) comparaciones
+Persona* buscarABB(Persona* raiz, int id) {
+    while (raiz != NULL && raiz->id != id)
+        raiz = (id < raiz->id) ? raiz->izq : raiz->der;
+    return raiz;
+}
+
+// ---------------------
+// ABB balanceado (AVL)
+// ---------------------
+
+// Diferencia de alturas entre el subárbol izquierdo y el derecho
+int factorBalance(Persona* p) {
+    return alturaNodo(p->izq) - alturaNodo(p->der);
+}
+
+// Rotación simple a la derecha: el hijo izquierdo sube
+Persona* rotarDerecha(Persona* y) {
+    Persona* x = y->izq;
+    y->izq = x->der;
+    if (y->izq != NULL) y->izq->padre = y;
+    x->der = y;
+    x->padre = y->padre;
+    y->padre = x;
+    actualizarAgregados(y);
+    actualizarAgregados(x);
+    return x;
+}
+
+// Rotación simple a la izquierda: el hijo derecho sube
+Persona* rotarIzquierda(Persona* x) {
+    Persona* y = x->der;
+    x->der = y->izq;
+    if (x->der != NULL) x->der->padre = x;
+    y->izq = x;
+    y->padre = x->padre;
+    x->padre = y;
+    actualizarAgregados(x);
+    actualizarAgregados(y);
+    return y;
+}
+
+// Restaura la propiedad AVL en un nodo cuyos hijos ya están balanceados
+Persona* balancear(Persona* p) {
+    actualizarAgregados(p);
+    int fb = factorBalance(p);
+
+    // Cargado a la izquierda (casos Izq-Izq e Izq-Der)
+    if (fb > 1) {
+        if (factorBalance(p->izq) < 0)
+            p->izq = rotarIzquierda(p->izq);
+        return rotarDerecha(p);
+    }
+    // Cargado a la derecha (casos Der-Der y Der-Izq)
+    if (fb < -1) {
+        if (factorBalance(p->der) > 0)
+            p->der = rotarDerecha(p->der);
+        return rotarIzquierda(p);
+    }
+    return p;
+}
+
+// Inserta una persona en el AVL según su ID y rebalancea el camino
+Persona* insertarAVL(Persona* raiz, Persona* nueva, EstadoArbol* estado) {
+    marcarArbolModificado();   // Las rotaciones mueven subárboles enteros
+    if (raiz == NULL) {
+        if (estado != NULL) *estado = ESTADO_OK;
+        return nueva;
+    }
+
+    if (nueva->id < raiz->id) {
+        raiz->izq = insertarAVL(raiz->izq, nueva, estado);
+        raiz->izq->padre = raiz;
+    } else if (nueva->id > raiz->id) {
+        raiz->der = insertarAVL(raiz->der, nueva, estado);
+        raiz->der->padre = raiz;
+    } else {
+        if (estado != NULL) *estado = ESTADO_ID_DUPLICADO;
+        liberarPersona(nueva);
+        return raiz;  // Nada cambió, no hace falta rebalancear
+    }
+
+    return balancear(raiz);
+}
+
+// Separa el nodo de menor ID de un subárbol AVL (sin liberarlo)
+Persona* extraerMinimoAVL(Persona* raiz, Persona*& minimo) {
+    if (raiz->izq == NULL) {
+        minimo = raiz;
+        return raiz->der;
+    }
+    raiz->izq = extraerMinimoAVL(raiz->izq, minimo);
+    if (raiz->izq != NULL) raiz->izq->padre = raiz;
+    return balancear(raiz);
+}
+
+// Elimina únicamente la persona indicada del AVL y rebalancea el camino.
+// Los nodos se re-enlazan (no se copian datos) para que el índice siga válido.
+Persona* eliminarAVL(Persona* raiz, int id) {
+    marcarArbolModificado();
+    if (raiz == NULL) return NULL;
+
+    if (id < raiz->id) {
+        raiz->izq = eliminarAVL(raiz->izq, id);
+        if (raiz->izq != NULL) raiz->izq->padre = raiz;
+    } else if (id > raiz->id) {
+        raiz->der = eliminarAVL(raiz->der, id);
+        if (raiz->der != NULL) raiz->der->padre = raiz;
+    } else {
+        Persona* izq = raiz->izq;
+        Persona* der = raiz->der;
+        Persona* padre = raiz->padre;
+        liberarPersona(raiz);
+
+        // Con uno o ningún hijo, ese hijo ocupa su lugar
+        if (izq == NULL || der == NULL) {
+            Persona* hijo = (izq != NULL) ? izq : der;
+            if (hijo != NULL) hijo->padre = padre;
+            return hijo;
+        }
+
+        // Con dos hijos, el sucesor in-orden ocupa su lugar
+        Persona* sucesor = NULL;
+        der = extraerMinimoAVL(der, sucesor);
+        sucesor->izq = izq;
+        izq->padre = sucesor;
+        sucesor->der = der;
+        if (der != NULL) der->padre = sucesor;
+        sucesor->padre = padre;
+        return balancear(sucesor);
+    }
+
+    return balancear(raiz);
+}
+
+// ---------------------
+// Construcción masiva de un ABB balanceado
+// ---------------------
+
+// Enlaza nodos ya ordenados por ID como un ABB de altura mínima en O(n).
+// El nodo de cada rango es su punto medio; los rangos pendientes se guardan
+// en una pila en lugar de usar recursión.
+Persona* enlazarBalanceado(const vector<Persona*>& ordenados) {
+    if (ordenados.empty()) return NULL;
+
+    struct Rango {
+        size_t ini, fin;     // Rango [ini, fin) del arreglo
+        Persona* padre;
+        bool esIzq;
+    };
+
+    Persona* raiz = NULL;
+    Pila<Rango> pila;
+    Rango todo = { 0, ordenados.size(), NULL, false };
+    pila.apilar(todo);
+
+    while (!pila.vacia()) {
+        Rango r = pila.desapilar();
+        size_t medio = r.ini + (r.fin - r.ini) / 2;
+        Persona* p = ordenados[medio];
+        p->izq = p->der = NULL;
+        p->padre = r.padre;
+
+        if (r.padre == NULL) raiz = p;
+        else if (r.esIzq) r.padre->izq = p;
+        else r.padre->der = p;
+
+        if (r.ini < medio)     { Rango izq = { r.ini, medio, p, true };      pila.apilar(izq); }
+        if (medio + 1 < r.fin) { Rango der = { medio + 1, r.fin, p, false }; pila.apilar(der); }
+    }
+
+    recalcularAgregados(raiz);
+    return raiz;
+}
+
+DatosPersona datosDePersona(const Persona* p) {
+    DatosPersona d = { p->id, p->nombre, p->apellido, p->edad,
+                       p->fechaNacimiento, p->ocupacion, p->genero };
+    return d;
+}
+
+// Construye un ABB de altura mínima a partir de datos (ordenados o no).
+// Se ordenan pares (ID, posición) en lugar de mover los datos con sus
+// cadenas. Todos los nodos se reservan juntos en un solo bloque del pool.
+// Ante IDs repetidos se conserva el primero; los que ya existen en el
+// índice se descartan. El resultado también cumple la propiedad AVL.
+Persona* construirABBBalanceado(const vector<DatosPersona>& datos) {
+    vector< pair<int, size_t> > claves(datos.size());
+    for (size_t i = 0; i < datos.size(); i++)
+        claves[i] = make_pair(datos[i].id, i);
+    if (!is_sorted(claves.begin(), claves.end()))
+        ordenarEnParalelo(claves, less< pair<int, size_t> >());
+
+    // Contar cuántos IDs son válidos para reservar el bloque exacto
+    vector<size_t> validos;
+    for (size_t i = 0; i < claves.size(); i++) {
+        if (i > 0 && claves[i].first == claves[i - 1].first) continue;
+        if (indicePorID.find(claves[i].first) != indicePorID.end()) continue;
+        validos.push_back(claves[i].second);
+    }
+
+    // Evitar que el índice se redimensione varias veces durante la carga
+    indicePorID.reserve(indicePorID.size() + validos.size());
+
+    // Los nodos quedan en memoria en el mismo orden que sus IDs
+    RanuraPersona* bloque = reservarPersonasContiguas((int)validos.size());
+    vector<Persona*> ordenados(validos.size());
+    for (size_t k = 0; k < validos.size(); k++) {
+        const DatosPersona& d = datos[validos[k]];
+        ordenados[k] = personaDeRanura(&bloque[k]);
+        inicializarPersona(ordenados[k], d.id, d.nombre, d.apellido, d.edad,
+                           d.fechaNacimiento, d.ocupacion, d.genero);
+    }
+
+    return enlazarBalanceado(ordenados);
+}
+
+// Reorganiza los nodos existentes como un ABB de altura mínima por ID,
+// sin reservar ni copiar personas (solo se re-enlazan)
+Persona* rebalancearComoABB(Persona* raiz) {
+    vector<Persona*> nodos;
+    Pila<Persona*> pila;
+    if (raiz != NULL) pila.apilar(raiz);
+    while (!pila.vacia()) {
+        Persona* actual = pila.desapilar();
+        nodos.push_back(actual);
+        if (actual->izq != NULL) pila.apilar(actual->izq);
+        if (actual->der != NULL) pila.apilar(actual->der);
+    }
+
+    ordenarEnParalelo(nodos, [](Persona* a, Persona* b) { return a->id < b->id; });
+    return enlazarBalanceado(nodos);
+}
+
+// Genera un árbol genealógico ficticio para pruebas
+Persona* generarArbolFicticio() {
+    // Crear raíz del árbol
+    Persona* raiz = crearPersona(1, "Carlos", "González", 75, "15/03/1950", "Jubilado", "Masculino");
+    
+    // Hijos directos
+    raiz->izq = crearPersona(2, "María", "González", 50, "22/07/1975", "Doctora", "Femenino");
+    raiz->der = crearPersona(3, "Roberto", "González", 48, "10/11/1977", "Ingeniero", "Masculino");
+    
+    // Nietos por lado izquierdo
+    raiz->izq->izq = crearPersona(4, "Ana", "Rodríguez", 28, "05/01/1997", "Abogada", "Femenino");
+    raiz->izq->der = crearPersona(5, "Pedro", "Rodríguez", 25, "18/09/2000", "Estudiante", "Masculino");
+    
+    // Nietos por lado derecho
+    raiz->der->izq = crearPersona(6, "Sofía", "González", 22, "30/04/2003", "Diseñadora", "Femenino");
+    raiz->der->der = crearPersona(7, "Luis", "González", 20, "12/12/2005", "Estudiante", "Masculino");
+    
+    // Bisnietos
+    raiz->izq->izq->izq = crearPersona(8, "Emma", "López", 5, "08/06/2020", "Preescolar", "Femenino");
+    raiz->izq->izq->der = crearPersona(9, "Lucas", "López", 3, "20/02/2022", "Preescolar", "Masculino");
+    
+    raiz->izq->der->izq = crearPersona(10, "Mía", "Rodríguez", 2, "14/08/2023", "N/A", "Femenino");
+    
+    // Completar padres y agregados (los nodos se enlazaron a mano)
+    recalcularAgregados(raiz);
+    return raiz; // Retorna el árbol listo
+}
+
+// ------------------------------------------------------
+// Generador sintético de árboles para pruebas de carga
+// ------------------------------------------------------
+
+// Tablas de nombres con peso decreciente: los primeros son los más frecuentes
+static const char* const NOMBRES_MASCULINOS[] = {
+    "Juan", "José", "Carlos", "Luis", "Miguel", "Jorge", "Pedro", "Roberto",
+    "Andrés", "Diego", "Fernando", "Ricardo", "Alejandro", "Manuel", "Javier",
+    "Santiago", "Mateo", "Sebastián", "Martín", "Lucas", "Tomás", "Emilio"
+};
+static const char* const NOMBRES_FEMENINOS[] = {
+    "María", "Ana", "Carmen", "Laura", "Lucía", "Sofía", "Isabel", "Elena",
+    "Paula", "Valentina", "Camila", "Gabriela", "Daniela", "Mariana", "Julia",
+    "Victoria", "Emma", "Mía", "Martina", "Renata", "Florencia", "Inés"
+};
+static const char* const APELLIDOS[] = {
+    "González", "Rodríguez", "Gómez", "Fernández", "López", "Díaz", "Martínez",
+    "Pérez", "García", "Sánchez", "Romero", "Sosa", "Torres", "Álvarez", "Ruiz",
+    "Ramírez", "Flores", "Benítez", "Acosta", "Medina", "Herrera", "Suárez",
+    "Aguirre", "Giménez", "Gutiérrez", "Molina", "Castro", "Ortiz", "Núñez", "Rojas"
+};
+static const char* const OCUPACIONES[] = {
+    "Comerciante", "Docente", "Empleado", "Agricultor", "Enfermera", "Ingeniero",
+    "Contador", "Abogada", "Doctora", "Albañil", "Carpintero", "Chofer",
+    "Cocinero", "Diseñadora", "Programador", "Arquitecta", "Electricista",
+    "Periodista", "Veterinaria", "Músico"
+};
+
+// Completa nombre, ocupación, género y fecha según el año de nacimiento
+// y la edad (la edad de los ancestros fallecidos es la que alcanzaron)
+void GeneradorSintetico::completarDatos(DatosPersona& d, int anioNacimiento, int edad, int apellido) {
+    bool masculino = (motor() & 1) != 0;
+    d.genero = masculino ? "Masculino" : "Femenino";
+    d.nombre = masculino
+        ? NOMBRES_MASCULINOS[indiceFrecuente(sizeof(NOMBRES_MASCULINOS) / sizeof(char*))]
+        : NOMBRES_FEMENINOS[indiceFrecuente(sizeof(NOMBRES_FEMENINOS) / sizeof(char*))];
+    d.apellido = APELLIDOS[apellido];
+    d.edad = edad;
+
+    if (edad < 6) d.ocupacion = "Preescolar";
+    else if (edad < 18) d.ocupacion = "Estudiante";
+    else if (edad >= 65 && anioNacimiento + edad >= ANIO_ACTUAL) d.ocupacion = "Jubilado";
+    else d.ocupacion = OCUPACIONES[indiceFrecuente(sizeof(OCUPACIONES) / sizeof(char*))];
+
+    char fecha[16];
+    snprintf(fecha, sizeof(fecha), "%02d/%02d/%04d", entre(1, 28), entre(1, 12), anioNacimiento);
+    d.fechaNacimiento = fecha;
+}
+
+// Datos para las formas sin restricciones familiares
+void GeneradorSintetico::datosSimples(DatosPersona& d) {
+    int edad = entre(0, 100);
+    completarDatos(d, ANIO_ACTUAL - edad, edad, apellidoFrecuente());
+}
+
+// Índice de un apellido de la tabla (los más comunes salen más seguido)
+int GeneradorSintetico::apellidoFrecuente() {
+    return indiceFrecuente(sizeof(APELLIDOS) / sizeof(char*));
+}
+
+// Arma en memoria un árbol sintético de n personas
+Persona* generarArbolSintetico(int n, FormaArbol forma, unsigned semilla) {
+    Persona* raiz = NULL;
+    indicePorID.reserve(indicePorID.size() + n);
+
+    generarPersonas(n, forma, semilla, [&raiz](const RegistroGenerado& r) {
+        const DatosPersona& d = r.datos;
+        Persona* p = crearPersona(d.id, d.nombre, d.apellido, d.edad,
+                                  d.fechaNacimiento, d.ocupacion, d.genero);
+        if (r.idPadre == 0) {
+            raiz = p;
+            return;
+        }
+        // El padre ya fue emitido: se ubica con el índice
+        Persona* padre = indicePorID[r.idPadre];
+        if (r.lado == 'I') padre->izq = p;
+        else padre->der = p;
+        p->padre = padre;
+    });
+
+    // Agregados de todo el árbol en una sola pasada
+    recalcularAgregados(raiz);
+    return raiz;
+}
+
+// Escribe un árbol sintético directamente como CSV (formato de importarCSV)
+// sin armarlo en memoria
+bool generarCSVSintetico(string nombreArchivo, int n, FormaArbol forma, unsigned semilla) {
+    ofstream archivo(nombreArchivo.c_str(), ios::binary);
+    if (!archivo.is_open()) return false;
+
+    archivo << "id,idPadre,lado,nombre,apellido,edad,fecha,ocupacion,genero\n";
+    string linea;
+    generarPersonas(n, forma, semilla, [&archivo, &linea](const RegistroGenerado& r) {
+        const DatosPersona& d = r.datos;
+        linea.clear();
+        linea += to_string(r.id);
+        linea += ',';
+        if (r.idPadre != 0) linea += to_string(r.idPadre);
+        linea += ',';
+        if (r.lado != '\0') linea += r.lado;
+        linea += ',' + d.nombre + ',' + d.apellido + ',' + to_string(d.edad) + ','
+               + d.fechaNacimiento + ',' + d.ocupacion + ',' + d.genero + '\n';
+        archivo.write(linea.data(), linea.size());
+    });
+
+    archivo.close();
+    return !archivo.fail();
+}
+
+// ---------------------
+// Exportación a texto con buffer propio
+// ---------------------
+
+// Tamaño del buffer de la exportación: se escribe en bloques de 1 MB en
+// lugar de una llamada (y un flush con endl) por línea
+const size_t BYTES_BUFFER_TEXTO = 1 << 20;
+
+// Espacios precalculados para la indentación (4 por nivel)
+const size_t ESPACIOS_SANGRIA = 4096;
+
+// Acumula la salida en memoria y la vuelca al destino en bloques grandes
+struct SalidaTexto {
+    string buffer;
+    FILE* archivo;       // Destino con stdio (archivo o tubería a gzip)
+    ostream* flujo;      // Destino si el llamador ya abrió un ofstream
+    size_t bytes;        // Total generado hasta ahora
+    bool error;
+
+    SalidaTexto() : archivo(NULL), flujo(NULL), bytes(0), error(false) {
+        buffer.reserve(BYTES_BUFFER_TEXTO);
+    }
+};
+
+// Vuelca lo acumulado al destino
+static void vaciarSalida(SalidaTexto& s) {
+    if (s.buffer.empty()) return;
+    if (s.archivo != NULL) {
+        if (fwrite(s.buffer.data(), 1, s.buffer.size(), s.archivo) != s.buffer.size())
+            s.error = true;
+    } else if (s.flujo != NULL) {
+        s.flujo->write(s.buffer.data(), s.buffer.size());
+        if (!*s.flujo) s.error = true;
+    }
+    s.buffer.clear();
+}
+
+static void anexarTexto(SalidaTexto& s, const char* texto, size_t largo) {
+    s.buffer.append(texto, largo);
+    s.bytes += largo;
+    if (s.buffer.size() >= BYTES_BUFFER_TEXTO) vaciarSalida(s);
+}
+
+static void anexarTexto(SalidaTexto& s, const char* texto) {
+    anexarTexto(s, texto, strlen(texto));
+}
+
+static void anexarTexto(SalidaTexto& s, const string& texto) {
+    anexarTexto(s, texto.data(), texto.size());
+}
+
+// Entero en decimal sin pasar por streams ni to_string
+static void anexarEntero(SalidaTexto& s, int valor) {
+    char digitos[12];
+    int largo = snprintf(digitos, sizeof(digitos), "%d", valor);
+    anexarTexto(s, digitos, (size_t)largo);
+}
+
+// Indentación de 'nivel' niveles copiada de un bloque de espacios fijo.
+// En un árbol degenerado la salida es cuadrática de por sí, pero cada
+// línea cuesta una copia en lugar de un operador << por nivel
+static void anexarSangria(SalidaTexto& s, int nivel) {
+    static const string espacios(ESPACIOS_SANGRIA, ' ');
+    size_t faltan = (size_t)nivel * 4;
+    while (faltan > 0) {
+        size_t tramo = faltan < ESPACIOS_SANGRIA ? faltan : ESPACIOS_SANGRIA;
+        anexarTexto(s, espacios.data(), tramo);
+        faltan -= tramo;
+    }
+}
+
+// Escribe los nodos en pre-orden con pila (mismo formato de siempre)
+static void escribirNodosTexto(Persona* raiz, SalidaTexto& salida,
+                               const ProgresoExportacion& progreso) {
+    if (raiz == NULL) return;
+
+    // Cada marco recuerda el nivel y la etiqueta que precede al nodo
+    struct Marco {
+        Persona* nodo;
+        int nivel;
+        const char* etiqueta;   // NULL para la raíz
+    };
+
+    size_t total = (size_t)raiz->tamano;
+    size_t escritos = 0;
+
+    Pila<Marco> pila;
+    Marco inicio = { raiz, 0, NULL };
+    pila.apilar(inicio);
+
+    while (!pila.vacia()) {
+        Marco m = pila.desapilar();
+
+        // Etiqueta del lado, con la indentación del padre
+        if (m.etiqueta != NULL) {
+            anexarSangria(salida, m.nivel - 1);
+            anexarTexto(salida, m.etiqueta);
+            anexarTexto(salida, "\n", 1);
+        }
+
+        // Índentación para mostrar estructura jerárquica
+        anexarSangria(salida, m.nivel);
+
+        // Guardar información del nodo actual
+        anexarTexto(salida, "+- ID: ");
+        anexarEntero(salida, m.nodo->id);
+        anexarTexto(salida, " | ");
+        anexarTexto(salida, m.nodo->nombre);
+        anexarTexto(salida, " ", 1);
+        anexarTexto(salida, m.nodo->apellido);
+        anexarTexto(salida, " | Edad: ");
+        anexarEntero(salida, m.nodo->edad);
+        anexarTexto(salida, " años | ");
+        anexarTexto(salida, m.nodo->ocupacion);
+        anexarTexto(salida, "\n", 1);
+
+        if (++escritos % NODOS_POR_AVISO == 0 && progreso)
+            progreso(escritos, total, salida.bytes);
+
+        // Apilar primero el derecho para que el izquierdo se escriba antes
+        if (m.nodo->der != NULL) {
+            Marco der = { m.nodo->der, m.nivel + 1, "¦  [Hijo Derecho]" };
+            pila.apilar(der);
+        }
+        if (m.nodo->izq != NULL) {
+            Marco izq = { m.nodo->izq, m.nivel + 1, "¦  [Hijo Izquierdo]" };
+            pila.apilar(izq);
+        }
+    }
+}
+
+// Guarda la estructura del árbol en un archivo de texto (pre-orden con pila)
+void guardarEnArchivo(Persona* raiz, ofstream& archivo) {
+    SalidaTexto salida;
+    salida.flujo = &archivo;
+    escribirNodosTexto(raiz, salida, ProgresoExportacion());
+    vaciarSalida(salida);
+}
+
+// Abre el destino de la exportación: un archivo común o, si el nombre
+// termina en ".gz", una tubería a "gzip -c"
+static FILE* abrirDestinoTexto(const string& nombreArchivo, bool& comprimido) {
+    const string gz = ".gz";
+    comprimido = nombreArchivo.size() > gz.size() &&
+                 nombreArchivo.compare(nombreArchivo.size() - gz.size(), gz.size(), gz) == 0;
+    if (!comprimido) return fopen(nombreArchivo.c_str(), "w");
+
+#ifndef _WIN32
+    // Nombre entre comillas simples para el shell ('  ->  '\'')
+    string comando = "gzip -c > '";
+    for (size_t i = 0; i < nombreArchivo.size(); i++) {
+        if (nombreArchivo[i] == '\'') comando += "'\\''";
+        else comando += nombreArchivo[i];
+    }
+    comando += "'";
+    return popen(comando.c_str(), "w");
+#else
+    return NULL;   // Sin compresión en Windows
+#endif
+}
+
+// Función que controla la escritura del árbol en archivo
+bool guardarArbolEnArchivo(Persona* raiz, string nombreArchivo, ProgresoExportacion progreso) {
+    bool comprimido;
+    FILE* archivo = abrirDestinoTexto(nombreArchivo, comprimido);
+
+    if (archivo == NULL) return false; // Error al abrir archivo
+
+    SalidaTexto salida;
+    salida.archivo = archivo;
+
+#ifndef _WIN32
+    // Si gzip termina antes de tiempo la escritura debe fallar con EPIPE
+    // en lugar de matar al programa con SIGPIPE
+    void (*senalAnterior)(int) = SIG_DFL;
+    if (comprimido) senalAnterior = signal(SIGPIPE, SIG_IGN);
+#endif
+
+    anexarTexto(salida, "-------------------------------------------------------\n");
+    anexarTexto(salida, "          ÁRBOL GENEALÓGICO FAMILIAR\n");
+    anexarTexto(salida, "-------------------------------------------------------\n\n");
+    
+    if (raiz == NULL) {
+        anexarTexto(salida, "El árbol está vacío.\n");
+    } else {
+        anexarTexto(salida, "[RAÍZ DEL ÁRBOL]\n");
+        escribirNodosTexto(raiz, salida, progreso);
+    }
+    
+    anexarTexto(salida, "\n-------------------------------------------------------\n");
+    vaciarSalida(salida);
+    if (progreso) progreso(raiz != NULL ? (size_t)raiz->tamano : 0,
+                           raiz != NULL ? (size_t)raiz->tamano : 0, salida.bytes);
+
+    // Con gzip, pclose devuelve el estado del proceso: distinto de 0 es error
+    int cierre = 0;
+#ifndef _WIN32
+    if (comprimido) {
+        cierre = pclose(archivo);
+        signal(SIGPIPE, senalAnterior);
+    } else
+#endif
+        cierre = fclose(archivo);
+    return !salida.error && cierre == 0; // Guardado exitoso
+}
+
+// ------------------------------------------------------
+// Snapshot binario (.arb)
+// ------------------------------------------------------
+
+const char     SNAPSHOT_MAGICO[4]  = { 'A', 'R', 'B', 'G' };
+const uint16_t SNAPSHOT_VERSION    = 1;
+const uint8_t  SNAPSHOT_TIENE_IZQ  = 1;
+const uint8_t  SNAPSHOT_TIENE_DER  = 2;
+
+// Agrega un entero sin signo como varint al buffer de salida
+static void escribirVarint(string& buffer, uint32_t valor) {
+    while (valor >= 0x80) {
+        buffer += (char)((valor & 0x7F) | 0x80);
+        valor >>= 7;
+    }
+    buffer += (char)valor;
+}
+
+// Agrega una cadena con su largo como prefijo
+static void escribirCadena(string& buffer, const string& texto) {
+    escribirVarint(buffer, (uint32_t)texto.size());
+    buffer += texto;
+}
+
+// Agrega un entero de largo fijo en little-endian
+static void escribirFijo(string& buffer, uint32_t valor, int bytes) {
+    for (int i = 0; i < bytes; i++)
+        buffer += (char)((valor >> (8 * i)) & 0xFF);
+}
+
+// Devuelve el índice de la cadena en la tabla, agregándola si es nueva
+static uint32_t indiceCadena(unordered_map<string, uint32_t>& indice,
+                             vector<string>& tabla, const string& texto) {
+    unordered_map<string, uint32_t>::iterator it = indice.find(texto);
+    if (it != indice.end()) return it->second;
+
+    uint32_t nuevo = (uint32_t)tabla.size();
+    indice[texto] = nuevo;
+    tabla.push_back(texto);
+    return nuevo;
+}
+
+// Guarda el árbol en formato binario compacto
+bool guardarSnapshotBinario(Persona* raiz, string nombreArchivo) {
+    ofstream archivo(nombreArchivo.c_str(), ios::binary);
+    if (!archivo.is_open()) return false;
+
+    // Primera pasada: armar la tabla de cadenas repetidas y los nodos
+    unordered_map<string, uint32_t> indice;
+    vector<string> tabla;
+    string nodos;
+    uint32_t cantidad = 0;
+
+    Pila<Persona*> pila;
+    if (raiz != NULL) pila.apilar(raiz);
+    while (!pila.vacia()) {
+        Persona* actual = pila.desapilar();
+        cantidad++;
+
+        uint8_t banderas = 0;
+        if (actual->izq != NULL) banderas |= SNAPSHOT_TIENE_IZQ;
+        if (actual->der != NULL) banderas |= SNAPSHOT_TIENE_DER;
+        nodos += (char)banderas;
+
+        // El ID puede ser negativo en un ABB: se codifica en zigzag
+        uint32_t id = ((uint32_t)actual->id << 1) ^ (uint32_t)(actual->id >> 31);
+        escribirVarint(nodos, id);
+        escribirVarint(nodos, (uint32_t)actual->edad);
+        escribirCadena(nodos, actual->nombre);
+        escribirCadena(nodos, actual->fechaNacimiento);
+        escribirVarint(nodos, indiceCadena(indice, tabla, actual->apellido));
+        escribirVarint(nodos, indiceCadena(indice, tabla, actual->ocupacion));
+        escribirVarint(nodos, indiceCadena(indice, tabla, actual->genero));
+
+        // Pre-orden: el izquierdo debe salir primero de la pila
+        if (actual->der != NULL) pila.apilar(actual->der);
+        if (actual->izq != NULL) pila.apilar(actual->izq);
+    }
+
+    // Encabezado y tabla de cadenas
+    string encabezado(SNAPSHOT_MAGICO, 4);
+    escribirFijo(encabezado, SNAPSHOT_VERSION, 2);
+    escribirFijo(encabezado, (uint32_t)tipoArbol, 1);
+    escribirFijo(encabezado, 0, 1);
+    escribirFijo(encabezado, cantidad, 4);
+    escribirVarint(encabezado, (uint32_t)tabla.size());
+    for (size_t i = 0; i < tabla.size(); i++)
+        escribirCadena(encabezado, tabla[i]);
+
+    archivo.write(encabezado.data(), encabezado.size());
+    archivo.write(nodos.data(), nodos.size());
+    archivo.close();
+    return !archivo.fail();
+}
+
+// Lee un varint del archivo; false si el archivo está truncado o dañado
+static bool leerVarint(istream& entrada, uint32_t& valor) {
+    valor = 0;
+    for (int desplazamiento = 0; desplazamiento < 35; desplazamiento += 7) {
+        int c = entrada.get();
+        if (c == EOF) return false;
+        valor |= (uint32_t)(c & 0x7F) << desplazamiento;
+        if ((c & 0x80) == 0) return true;
+    }
+    return false;   // Demasiados bytes para un entero de 32 bits
+}
+
+// Lee una cadena con prefijo de largo
+static bool leerCadena(istream& entrada, string& texto) {
+    uint32_t largo;
+    if (!leerVarint(entrada, largo)) return false;
+    if (largo > (1u << 24)) return false;   // Largo absurdo: archivo dañado
+    texto.resize(largo);
+    if (largo > 0) entrada.read(&texto[0], largo);
+    return entrada.gcount() == (streamsize)largo || largo == 0;
+}
+
+// Lee un entero de largo fijo en little-endian
+static bool leerFijo(istream& entrada, uint32_t& valor, int bytes) {
+    valor = 0;
+    for (int i = 0; i < bytes; i++) {
+        int c = entrada.get();
+        if (c == EOF) return false;
+        valor |= (uint32_t)c << (8 * i);
+    }
+    return true;
+}
+
+// Nodo del snapshot ya leído y validado, antes de crear la persona
+struct FilaSnapshot {
+    int id;
+    int edad;
+    int banderas;
+    string nombre, fecha;
+    uint32_t apellido, ocupacion, genero;   // Índices en la tabla de cadenas
+};
+
+// Tope de la reserva inicial: un encabezado dañado no debe pedir gigabytes
+const uint32_t SNAPSHOT_RESERVA_MAXIMA = 1u << 20;
+
+// Carga un snapshot binario leyendo el archivo una sola vez.
+// El árbol se reconstruye enlazando cada nodo en el hueco que le corresponde
+// según las banderas de su padre. Si el archivo es inválido no se modifica nada.
+bool cargarSnapshotBinario(string nombreArchivo, Persona*& raiz) {
+    ifstream archivo(nombreArchivo.c_str(), ios::binary);
+    if (!archivo.is_open()) return false;
+
+    // Encabezado
+    char magico[4];
+    uint32_t version, tipo, reservado, cantidad, cantidadCadenas;
+    archivo.read(magico, 4);
+    if (archivo.gcount() != 4 || string(magico, 4) != string(SNAPSHOT_MAGICO, 4)) return false;
+    if (!leerFijo(archivo, version, 2) || version != SNAPSHOT_VERSION) return false;
+    if (!leerFijo(archivo, tipo, 1) || tipo > ARBOL_AVL) return false;
+    if (!leerFijo(archivo, reservado, 1) || !leerFijo(archivo, cantidad, 4)) return false;
+
+    // Tabla de cadenas
+    if (!leerVarint(archivo, cantidadCadenas)) return false;
+    vector<string> tabla;
+    for (uint32_t i = 0; i < cantidadCadenas; i++) {
+        string texto;
+        if (!leerCadena(archivo, texto)) return false;
+        tabla.push_back(texto);
+    }
+
+    // Primera pasada: leer y validar todos los nodos sin crear personas, así
+    // un archivo dañado no toca el árbol actual ni los índices. huecos cuenta
+    // los hijos anunciados que todavía no aparecieron.
+    vector<FilaSnapshot> filas;
+    filas.reserve(cantidad < SNAPSHOT_RESERVA_MAXIMA ? cantidad : SNAPSHOT_RESERVA_MAXIMA);
+    unordered_set<int> ids;
+    uint32_t huecos = 1;
+
+    for (uint32_t n = 0; n < cantidad; n++) {
+        FilaSnapshot f;
+        uint32_t id, edad;
+        f.banderas = archivo.get();
+
+        bool valido = f.banderas != EOF && huecos > 0
+                   && leerVarint(archivo, id) && leerVarint(archivo, edad)
+                   && leerCadena(archivo, f.nombre) && leerCadena(archivo, f.fecha)
+                   && leerVarint(archivo, f.apellido) && f.apellido < tabla.size()
+                   && leerVarint(archivo, f.ocupacion) && f.ocupacion < tabla.size()
+                   && leerVarint(archivo, f.genero) && f.genero < tabla.size();
+        if (!valido) return false;
+
+        // Decodificar zigzag y rechazar IDs repetidos
+        f.id = (int)((id >> 1) ^ (~(id & 1) + 1));
+        f.edad = (int)edad;
+        if (!ids.insert(f.id).second) return false;
+
+        huecos--;
+        if (f.banderas & SNAPSHOT_TIENE_IZQ) huecos++;
+        if (f.banderas & SNAPSHOT_TIENE_DER) huecos++;
+        filas.push_back(f);
+    }
+
+    // Todos los huecos anunciados deben haberse llenado. Un árbol vacío
+    // (cantidad 0, por ejemplo el checkpoint tras limpiar) deja sin llenar
+    // solo el hueco de la raíz y es válido.
+    if (cantidad > 0 && huecos > 0) return false;
+
+    // Segunda pasada: el archivo es válido, recién ahora se reemplaza el árbol.
+    // La pila guarda los huecos (punteros a hijo) que faltan llenar.
+    limpiarArbolCompleto(raiz);
+    Persona* nueva = NULL;
+    Pila<Persona**> pendientes;
+    pendientes.apilar(&nueva);
+    for (size_t n = 0; n < filas.size(); n++) {
+        const FilaSnapshot& f = filas[n];
+        Persona* p = crearPersona(f.id, f.nombre, tabla[f.apellido], f.edad,
+                                  f.fecha, tabla[f.ocupacion], tabla[f.genero]);
+        *pendientes.desapilar() = p;
+
+        // El hueco izquierdo se llena primero, así que se apila último
+        if (f.banderas & SNAPSHOT_TIENE_DER) pendientes.apilar(&p->der);
+        if (f.banderas & SNAPSHOT_TIENE_IZQ) pendientes.apilar(&p->izq);
+    }
+
+    recalcularAgregados(nueva);   // Padres, alturas y estadísticas
+    tipoArbol = (TipoArbol)tipo;
+    raiz = nueva;
+    return true;
+}
+
+// ------------------------------------------------------
+// Registro de cambios (.wal)
+// ------------------------------------------------------
+//
+// Encabezado: "ARBW", versión (2 bytes), reservado (2 bytes), CRC y largo
+// del checkpoint al que sigue el registro (4 + 4 bytes). Si al recuperar el
+// checkpoint no coincide, el registro es de uno anterior: un corte entre
+// guardar el checkpoint y vaciar el registro. Sus cambios ya están en el
+// checkpoint y se ignoran.
+//
+// Cada registro: largo de los datos (4 bytes), operación (1 byte), datos y
+// CRC-32 de operación + datos (4 bytes).
+
+const char     REGISTRO_MAGICO[4]        = { 'A', 'R', 'B', 'W' };
+const uint16_t REGISTRO_VERSION          = 1;
+const size_t   REGISTRO_TAM_ENCABEZADO   = 16;
+const uint32_t REGISTRO_MAX_DATOS        = 1 << 26;   // Largo absurdo: registro dañado
+
+// Tabla del CRC-32 (polinomio de zlib)
+static vector<uint32_t> crearTablaCRC32() {
+    vector<uint32_t> tabla(256);
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        tabla[i] = c;
+    }
+    return tabla;
+}
+
+static uint32_t calcularCRC32(const char* datos, size_t largo) {
+    static const vector<uint32_t> tabla = crearTablaCRC32();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < largo; i++)
+        crc = tabla[(crc ^ (uint8_t)datos[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// Lee un archivo entero a memoria (false si no existe)
+static bool leerArchivoCompleto(const string& nombre, string& contenido) {
+    ifstream archivo(nombre.c_str(), ios::binary);
+    if (!archivo.is_open()) return false;
+    contenido.assign(istreambuf_iterator<char>(archivo), istreambuf_iterator<char>());
+    return true;
+}
+
+// Fuerza al disco lo escrito en un archivo ya cerrado
+static bool sincronizarArchivo(const string& nombre) {
+#ifndef _WIN32
+    int fd = open(nombre.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+#else
+    (void)nombre;
+    return true;
+#endif
+}
+
+// Escribe el contenido en un temporal y lo renombra: el archivo queda con
+// el contenido viejo o con el nuevo, nunca a medias
+static bool reemplazarArchivo(const string& nombre, const string& contenido) {
+    string temporal = nombre + ".tmp";
+    {
+        ofstream archivo(temporal.c_str(), ios::binary | ios::trunc);
+        if (!archivo.is_open()) return false;
+        archivo.write(contenido.data(), contenido.size());
+        archivo.close();
+        if (archivo.fail()) return false;
+    }
+    if (!sincronizarArchivo(temporal)) return false;
+#ifdef _WIN32
+    remove(nombre.c_str());   // rename no reemplaza en Windows
+#endif
+    return rename(temporal.c_str(), nombre.c_str()) == 0;
+}
+
+// Lee un varint de un buffer en memoria avanzando pos
+static bool leerVarintMemoria(const string& datos, size_t& pos, uint32_t& valor) {
+    valor = 0;
+    for (int desplazamiento = 0; desplazamiento < 35 && pos < datos.size(); desplazamiento += 7) {
+        uint8_t c = (uint8_t)datos[pos++];
+        valor |= (uint32_t)(c & 0x7F) << desplazamiento;
+        if ((c & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+// Lee una cadena con prefijo de largo de un buffer en memoria
+static bool leerCadenaMemoria(const string& datos, size_t& pos, string& texto) {
+    uint32_t largo;
+    if (!leerVarintMemoria(datos, pos, largo) || largo > datos.size() - pos) return false;
+    texto.assign(datos, pos, largo);
+    pos += largo;
+    return true;
+}
+
+// Lee un entero de largo fijo en little-endian de un buffer en memoria
+static uint32_t leerFijoMemoria(const string& datos, size_t pos, int bytes) {
+    uint32_t valor = 0;
+    for (int i = 0; i < bytes; i++) valor |= (uint32_t)(uint8_t)datos[pos + i] << (8 * i);
+    return valor;
+}
+
+// Enteros con signo en zigzag (igual que en el snapshot)
+static uint32_t zigzag(int valor)   { return ((uint32_t)valor << 1) ^ (uint32_t)(valor >> 31); }
+static int deszigzag(uint32_t valor) { return (int)((valor >> 1) ^ (~(valor & 1) + 1)); }
+
+// Encabezado de un registro nuevo que sigue al checkpoint indicado
+static string encabezadoRegistro(uint32_t crcCheckpoint, uint32_t largoCheckpoint) {
+    string encabezado(REGISTRO_MAGICO, 4);
+    escribirFijo(encabezado, REGISTRO_VERSION, 2);
+    escribirFijo(encabezado, 0, 2);
+    escribirFijo(encabezado, crcCheckpoint, 4);
+    escribirFijo(encabezado, largoCheckpoint, 4);
+    return encabezado;
+}
+
+// Escribe los pendientes y hace fsync (con el cerrojo ya tomado)
+static bool sincronizarPendientes(RegistroCambios& reg) {
+    if (reg.archivo == NULL) return false;
+    if (reg.pendiente.empty()) return true;
+
+    bool ok = fwrite(reg.pendiente.data(), 1, reg.pendiente.size(), reg.archivo) == reg.pendiente.size()
+           && fflush(reg.archivo) == 0;
+#ifndef _WIN32
+    ok = ok && fsync(fileno(reg.archivo)) == 0;
+#endif
+    reg.pendiente.clear();
+    reg.registrosPendientes = 0;
+    return ok;
+}
+
+// Hilo temporizador: sincroniza el lote pendiente cuando vence su plazo,
+// aunque no lleguen más registros que lo completen
+static void esperarPlazosDeLote(RegistroCambios* reg) {
+    unique_lock<mutex> bloqueo(reg->cerrojo);
+    while (!reg->cerrando) {
+        if (reg->registrosPendientes == 0)
+            reg->hayPendientes.wait(bloqueo);
+        else if (chrono::steady_clock::now() >= reg->plazoLote)
+            sincronizarPendientes(*reg);
+        else
+            reg->hayPendientes.wait_until(bloqueo, reg->plazoLote);
+    }
+}
+
+// Agrega un registro completo (largo, operación, datos, CRC) a los pendientes
+static void agregarRegistro(RegistroCambios& reg, OperacionRegistro op, const string& datos) {
+    string cuerpo(1, (char)op);
+    cuerpo += datos;
+    bool loteNuevo;
+    {
+        lock_guard<mutex> bloqueo(reg.cerrojo);
+        loteNuevo = reg.registrosPendientes == 0;
+        if (loteNuevo) reg.plazoLote = chrono::steady_clock::now() + chrono::milliseconds(reg.msPorLote);
+
+        escribirFijo(reg.pendiente, (uint32_t)datos.size(), 4);
+        reg.pendiente += cuerpo;
+        escribirFijo(reg.pendiente, calcularCRC32(cuerpo.data(), cuerpo.size()), 4);
+        reg.registrosPendientes++;
+        reg.registrosEnArchivo++;
+
+        // Commit en grupo: un solo fsync para todo el lote. Si el lote no
+        // se llena, el temporizador lo sincroniza al vencer el plazo.
+        if (reg.registrosPendientes >= reg.registrosPorLote) {
+            sincronizarPendientes(reg);
+            loteNuevo = false;
+        }
+    }
+    if (loteNuevo) reg.hayPendientes.notify_one();
+}
+
+void registrarAlta(RegistroCambios& reg, OperacionRegistro op, const Persona* p,
+                   int idPadre, char lado) {
+    string datos;
+    if (op == REGISTRO_HIJO) {
+        escribirVarint(datos, zigzag(idPadre));
+        datos += lado;
+    }
+    escribirVarint(datos, zigzag(p->id));
+    escribirVarint(datos, (uint32_t)p->edad);
+    escribirCadena(datos, p->nombre);
+    escribirCadena(datos, p->apellido);
+    escribirCadena(datos, p->fechaNacimiento);
+    escribirCadena(datos, p->ocupacion);
+    escribirCadena(datos, p->genero);
+    agregarRegistro(reg, op, datos);
+}
+
+void registrarBaja(RegistroCambios& reg, OperacionRegistro op, int id) {
+    string datos;
+    if (op != REGISTRO_LIMPIAR) escribirVarint(datos, zigzag(id));
+    agregarRegistro(reg, op, datos);
+}
+
+bool sincronizarRegistro(RegistroCambios& reg) {
+    lock_guard<mutex> bloqueo(reg.cerrojo);
+    return sincronizarPendientes(reg);
+}
+
+// Aplica un registro al árbol; false si sus datos no tienen sentido
+static bool aplicarRegistro(uint8_t op, const string& datos, Persona*& raiz) {
+    size_t pos = 0;
+    uint32_t valor;
+
+    if (op == REGISTRO_LIMPIAR) {
+        limpiarArbolCompleto(raiz);
+        tipoArbol = ARBOL_GENEALOGICO;
+        return true;
+    }
+    if (op == REGISTRO_ELIMINAR || op == REGISTRO_ELIMINAR_AVL) {
+        if (!leerVarintMemoria(datos, pos, valor)) return false;
+        int id = deszigzag(valor);
+        raiz = (op == REGISTRO_ELIMINAR_AVL) ? eliminarAVL(raiz, id) : eliminarPersona(raiz, id);
+        return true;
+    }
+    if (op < REGISTRO_RAIZ || op > REGISTRO_AVL) return false;
+
+    // Altas: (idPadre, lado) si es un hijo, luego los datos de la persona
+    int idPadre = 0;
+    char lado = 0;
+    if (op == REGISTRO_HIJO) {
+        if (!leerVarintMemoria(datos, pos, valor) || pos >= datos.size()) return false;
+        idPadre = deszigzag(valor);
+        lado = datos[pos++];
+    }
+    uint32_t id, edad;
+    string nombre, apellido, fecha, ocupacion, genero;
+    if (!leerVarintMemoria(datos, pos, id) || !leerVarintMemoria(datos, pos, edad) ||
+        !leerCadenaMemoria(datos, pos, nombre) || !leerCadenaMemoria(datos, pos, apellido) ||
+        !leerCadenaMemoria(datos, pos, fecha) || !leerCadenaMemoria(datos, pos, ocupacion) ||
+        !leerCadenaMemoria(datos, pos, genero))
+        return false;
+    if (buscar(raiz, deszigzag(id)) != NULL) return false;
+
+    Persona* p = crearPersona(deszigzag(id), nombre, apellido, (int)edad, fecha, ocupacion, genero);
+    if (op == REGISTRO_RAIZ) {
+        eliminarArbol(raiz);
+        raiz = p;
+        tipoArbol = ARBOL_GENEALOGICO;
+    } else if (op == REGISTRO_HIJO) {
+        EstadoArbol estado = insertarHijo(raiz, idPadre, p, lado);
+        if (estado != ESTADO_OK && estado != ESTADO_REEMPLAZADO) {
+            liberarPersona(p);
+            return false;
+        }
+        tipoArbol = ARBOL_GENEALOGICO;
+    } else if (op == REGISTRO_ABB) {
+        if (raiz == NULL || tipoArbol == ARBOL_AVL) tipoArbol = ARBOL_ABB;
+        raiz = insertarABB(raiz, p);
+    } else {
+        raiz = insertarAVL(raiz, p);
+        tipoArbol = ARBOL_AVL;
+    }
+    return true;
+}
+
+bool abrirRegistro(RegistroCambios& reg, string base, Persona*& raiz, ResultadoRecuperacion& res) {
+    reg.base = base;
+    reg.archivo = NULL;
+    reg.pendiente.clear();
+    reg.registrosPendientes = 0;
+    reg.registrosEnArchivo = 0;
+    reg.cerrando = false;
+    reg.registrosPorLote = 256;
+    reg.msPorLote = 50;
+    reg.registrosPorCheckpoint = 1000000;
+    res.habiaCheckpoint = false;
+    res.aplicados = 0;
+    res.colaDescartada = false;
+    res.registroViejo = false;
+
+    // 1. Último checkpoint (si hay)
+    string nombreCheckpoint = base + ".arb", nombreRegistro = base + ".wal";
+    string checkpoint, registro;
+    uint32_t crcCheckpoint = 0, largoCheckpoint = 0;
+    if (leerArchivoCompleto(nombreCheckpoint, checkpoint)) {
+        if (!cargarSnapshotBinario(nombreCheckpoint, raiz)) return false;
+        res.habiaCheckpoint = true;
+        crcCheckpoint = calcularCRC32(checkpoint.data(), checkpoint.size());
+        largoCheckpoint = (uint32_t)checkpoint.size();
+    }
+
+    // 2. Cambios posteriores, hasta el primer registro incompleto o dañado
+    size_t valido = 0;
+    if (leerArchivoCompleto(nombreRegistro, registro) && registro.size() >= REGISTRO_TAM_ENCABEZADO) {
+        if (string(registro, 0, 4) != string(REGISTRO_MAGICO, 4) ||
+            leerFijoMemoria(registro, 4, 2) != REGISTRO_VERSION)
+            return false;   // No es un registro: no se toca
+
+        if (leerFijoMemoria(registro, 8, 4) != crcCheckpoint ||
+            leerFijoMemoria(registro, 12, 4) != largoCheckpoint) {
+            res.registroViejo = true;
+        } else {
+            size_t pos = REGISTRO_TAM_ENCABEZADO;
+            valido = pos;
+            while (pos + 9 <= registro.size()) {
+                uint32_t largo = leerFijoMemoria(registro, pos, 4);
+                if (largo > REGISTRO_MAX_DATOS || pos + 9 + largo > registro.size()) break;
+                const char* cuerpo = registro.data() + pos + 4;
+                if (calcularCRC32(cuerpo, largo + 1) != leerFijoMemoria(registro, pos + 5 + largo, 4)) break;
+                if (!aplicarRegistro((uint8_t)cuerpo[0], string(cuerpo + 1, largo), raiz)) break;
+                res.aplicados++;
+                pos += 9 + largo;
+                valido = pos;
+            }
+            res.colaDescartada = valido < registro.size();
+        }
+    } else if (!registro.empty()) {
+        res.colaDescartada = true;   // Corte al escribir el encabezado
+    }
+    reg.registrosEnArchivo = res.aplicados;
+
+    // 3. Dejar en disco solo la parte válida y abrir para agregar
+    if (valido == 0) {
+        if (!reemplazarArchivo(nombreRegistro, encabezadoRegistro(crcCheckpoint, largoCheckpoint)))
+            return false;
+    } else if (res.colaDescartada) {
+        if (!reemplazarArchivo(nombreRegistro, registro.substr(0, valido))) return false;
+    }
+    reg.archivo = fopen(nombreRegistro.c_str(), "ab");
+    if (reg.archivo == NULL) return false;
+    reg.temporizador = thread(esperarPlazosDeLote, &reg);
+    return true;
+}
+
+bool checkpointRegistro(RegistroCambios& reg, Persona* raiz) {
+    lock_guard<mutex> bloqueo(reg.cerrojo);   // El temporizador no toca el archivo mientras tanto
+    if (reg.archivo == NULL) return false;
+    sincronizarPendientes(reg);
+
+    // El snapshot se arma en un temporal y reemplaza al anterior de una vez
+    string nombreCheckpoint = reg.base + ".arb", temporal = nombreCheckpoint + ".tmp";
+    string checkpoint;
+    if (!guardarSnapshotBinario(raiz, temporal) || !sincronizarArchivo(temporal) ||
+        !leerArchivoCompleto(temporal, checkpoint))
+        return false;
+#ifdef _WIN32
+    remove(nombreCheckpoint.c_str());
+#endif
+    if (rename(temporal.c_str(), nombreCheckpoint.c_str()) != 0) return false;
+
+    // Registro nuevo que apunta a este checkpoint. Si se corta antes de
+    // llegar acá, el registro anterior no coincide y se ignora al recuperar.
+    fclose(reg.archivo);
+    reg.archivo = NULL;
+    string nombreRegistro = reg.base + ".wal";
+    if (!reemplazarArchivo(nombreRegistro, encabezadoRegistro(calcularCRC32(checkpoint.data(), checkpoint.size()),
+                                                             (uint32_t)checkpoint.size())))
+        return false;
+    reg.archivo = fopen(nombreRegistro.c_str(), "ab");
+    reg.registrosEnArchivo = 0;
+    return reg.archivo != NULL;
+}
+
+bool checkpointSiCorresponde(RegistroCambios& reg, Persona* raiz) {
+    if (reg.registrosEnArchivo < reg.registrosPorCheckpoint) return true;
+    return checkpointRegistro(reg, raiz);
+}
+
+void cerrarRegistro(RegistroCambios& reg) {
+    if (reg.temporizador.joinable()) {
+        {
+            lock_guard<mutex> bloqueo(reg.cerrojo);
+            reg.cerrando = true;
+        }
+        reg.hayPendientes.notify_one();
+        reg.temporizador.join();
+    }
+    if (reg.archivo == NULL) return;
+    sincronizarPendientes(reg);
+    fclose(reg.archivo);
+    reg.archivo = NULL;
+}
+
+// ------------------------------------------------------
+// Guardado incremental por segmentos (.ars)
+// ------------------------------------------------------
+
+const char     SEGMENTOS_MAGICO[4]      = { 'A', 'R', 'B', 'S' };
+const uint16_t SEGMENTOS_VERSION        = 1;
+const size_t   SEGMENTOS_TAM_ENCABEZADO = 32;
+const uint64_t SEGMENTOS_INICIO_DATOS   = 2 * SEGMENTOS_TAM_ENCABEZADO;
+const uint32_t SEGMENTO_NINGUNO         = 0xFFFFFFFFu;   // Árbol vacío
+const uint8_t  HIJO_SIGUE               = 1;   // El hijo viene a continuación
+const uint8_t  HIJO_REFERENCIA          = 2;   // El hijo es raíz de otro segmento
+
+// Si la basura supera a lo vigente (más este margen) se reescribe entero
+const uint64_t SEGMENTOS_MARGEN_BASURA  = 1 << 16;
+
+GuardadoIncremental guardadoIncremental;
+
+static void escribirFijo64(string& buffer, uint64_t valor) {
+    escribirFijo(buffer, (uint32_t)valor, 4);
+    escribirFijo(buffer, (uint32_t)(valor >> 32), 4);
+}
+
+static uint64_t leerFijo64Memoria(const string& datos, size_t pos) {
+    return leerFijoMemoria(datos, pos, 4) | ((uint64_t)leerFijoMemoria(datos, pos + 4, 4) << 32);
+}
+
+// Agrega un bloque (segmento o directorio) con su largo y CRC
+static void agregarBloque(string& salida, const string& datos) {
+    escribirFijo(salida, (uint32_t)datos.size(), 4);
+    escribirFijo(salida, calcularCRC32(datos.data(), datos.size()), 4);
+    salida += datos;
+}
+
+// Lee el bloque que empieza en pos, verificando largo y CRC
+static bool leerBloque(const string& archivo, uint64_t pos, string& datos) {
+    if (pos < SEGMENTOS_INICIO_DATOS || pos + 8 > archivo.size()) return false;
+    uint32_t largo = leerFijoMemoria(archivo, (size_t)pos, 4);
+    if (largo > archivo.size() - pos - 8) return false;
+    datos.assign(archivo, (size_t)pos + 8, largo);
+    return calcularCRC32(datos.data(), datos.size()) == leerFijoMemoria(archivo, (size_t)pos + 4, 4);
+}
+
+static string encabezadoSegmentos(uint64_t secuencia, uint64_t directorio, uint32_t raiz) {
+    string e(SEGMENTOS_MAGICO, 4);
+    escribirFijo(e, SEGMENTOS_VERSION, 2);
+    escribirFijo(e, (uint32_t)tipoArbol, 1);
+    escribirFijo(e, 0, 1);
+    escribirFijo64(e, secuencia);
+    escribirFijo64(e, directorio);
+    escribirFijo(e, raiz, 4);
+    escribirFijo(e, calcularCRC32(e.data(), e.size()), 4);
+    return e;
+}
+
+// Fuerza al disco lo escrito en un archivo abierto
+static bool sincronizarAbierto(FILE* archivo) {
+    if (fflush(archivo) != 0) return false;
+#ifndef _WIN32
+    return fsync(fileno(archivo)) == 0;
+#else
+    return true;
+#endif
+}
+
+void marcarSubarbolModificado(Persona* p) {
+    invalidarParentesco();
+    GuardadoIncremental& g = guardadoIncremental;
+    if (g.nombreArchivo.empty() || g.todoSucio) return;
+
+    // El segmento de p es el de su ancestro más cercano que sea raíz de uno
+    for (; p != NULL; p = p->padre) {
+        unordered_map<Persona*, uint32_t>::iterator it = g.segmentoDeRaiz.find(p);
+        if (it == g.segmentoDeRaiz.end()) continue;
+        SegmentoGuardado& s = g.segmentos[it->second];
+        if (!s.sucio) {
+            s.sucio = true;
+            g.sucios.push_back(it->second);
+        }
+        return;
+    }
+    marcarArbolModificado();   // p no está en el árbol guardado
+}
+
+void marcarArbolModificado() {
+    invalidarParentesco();
+    GuardadoIncremental& g = guardadoIncremental;
+    if (g.nombreArchivo.empty() || g.todoSucio) return;
+    g.todoSucio = true;
+    g.segmentoDeRaiz.clear();   // Puede quedar apuntando a nodos liberados
+    g.sucios.clear();
+}
+
+void olvidarPersonaGuardada(Persona* p) {
+    invalidarParentesco();
+    GuardadoIncremental& g = guardadoIncremental;
+    if (g.segmentoDeRaiz.empty()) return;
+
+    unordered_map<Persona*, uint32_t>::iterator it = g.segmentoDeRaiz.find(p);
+    if (it == g.segmentoDeRaiz.end()) return;
+    if (p == g.raiz) {
+        marcarArbolModificado();
+        return;
+    }
+
+    // El segmento entero se fue con su raíz (su padre ya quedó sucio)
+    uint32_t numero = it->second;
+    g.segmentoDeRaiz.erase(it);
+    SegmentoGuardado& s = g.segmentos[numero];
+    g.bytesVigentes -= s.largo;
+    SegmentoGuardado libre = { NULL, 0, 0, false };
+    s = libre;
+    g.libres.push_back(numero);
+}
+
+// Asigna un número (reutilizando los libres) a un segmento nuevo
+static uint32_t nuevoSegmento(GuardadoIncremental& g, Persona* raiz) {
+    uint32_t numero;
+    if (!g.libres.empty()) {
+        numero = g.libres.back();
+        g.libres.pop_back();
+    } else {
+        numero = (uint32_t)g.segmentos.size();
+        g.segmentos.push_back(SegmentoGuardado());
+    }
+    SegmentoGuardado s = { raiz, 0, 0, false };
+    g.segmentos[numero] = s;
+    g.segmentoDeRaiz[raiz] = numero;
+    return numero;
+}
+
+// Tipo de enlace hacia un hijo dentro de un segmento
+static uint8_t enlaceHijo(const GuardadoIncremental& g, Persona* hijo) {
+    if (hijo == NULL) return 0;
+    return g.segmentoDeRaiz.count(hijo) ? HIJO_REFERENCIA : HIJO_SIGUE;
+}
+
+// Parte un segmento: cada subárbol que junta PERSONAS_POR_SEGMENTO personas
+// pasa a ser un segmento propio, así ninguno llega al doble. Devuelve los
+// segmentos a escribir (el original primero).
+static vector<uint32_t> particionarSegmento(GuardadoIncremental& g, uint32_t numero) {
+    // Personas del segmento en pre-orden, con qué hijos siguen en él
+    vector<Persona*> nodos;
+    vector<uint8_t> enlaces;
+    Pila<Persona*> pila;
+    pila.apilar(g.segmentos[numero].raiz);
+    while (!pila.vacia()) {
+        Persona* p = pila.desapilar();
+        uint8_t izq = enlaceHijo(g, p->izq), der = enlaceHijo(g, p->der);
+        nodos.push_back(p);
+        enlaces.push_back((uint8_t)(izq | (der << 2)));
+        if (der == HIJO_SIGUE) pila.apilar(p->der);
+        if (izq == HIJO_SIGUE) pila.apilar(p->izq);
+    }
+
+    // De atrás hacia adelante los descendientes ya están procesados.
+    // cuenta = personas del subárbol dentro del segmento (para ubicar al
+    // hijo derecho en pre-orden), resto = las que quedan sin separar.
+    vector<int> cuenta(nodos.size()), resto(nodos.size());
+    vector<uint32_t> escribir(1, numero);
+    for (size_t i = nodos.size(); i-- > 0; ) {
+        cuenta[i] = resto[i] = 1;
+        size_t hijo = i + 1;
+        if ((enlaces[i] & 3) == HIJO_SIGUE) {
+            cuenta[i] += cuenta[hijo];
+            resto[i] += resto[hijo];
+            hijo += cuenta[hijo];
+        }
+        if ((enlaces[i] >> 2) == HIJO_SIGUE) {
+            cuenta[i] += cuenta[hijo];
+            resto[i] += resto[hijo];
+        }
+        if (i > 0 && resto[i] >= PERSONAS_POR_SEGMENTO) {
+            escribir.push_back(nuevoSegmento(g, nodos[i]));
+            resto[i] = 0;
+        }
+    }
+    return escribir;
+}
+
+// Agrega a salida el registro de un segmento; inicio es la posición en el
+// archivo donde va a quedar salida
+static void escribirSegmento(GuardadoIncremental& g, uint32_t numero, string& salida,
+                             uint64_t inicio, ResultadoGuardado& r) {
+    SegmentoGuardado& s = g.segmentos[numero];
+    string cuerpo;
+    uint32_t personas = 0;
+
+    Pila<Persona*> pila;
+    pila.apilar(s.raiz);
+    while (!pila.vacia()) {
+        Persona* p = pila.desapilar();
+        uint8_t izq = enlaceHijo(g, p->izq), der = enlaceHijo(g, p->der);
+        personas++;
+
+        cuerpo += (char)(izq | (der << 2));
+        escribirVarint(cuerpo, zigzag(p->id));
+        escribirVarint(cuerpo, (uint32_t)p->edad);
+        escribirCadena(cuerpo, p->nombre);
+        escribirCadena(cuerpo, p->apellido);
+        escribirCadena(cuerpo, p->fechaNacimiento);
+        escribirCadena(cuerpo, p->ocupacion);
+        escribirCadena(cuerpo, p->genero);
+        if (izq == HIJO_REFERENCIA) escribirVarint(cuerpo, g.segmentoDeRaiz[p->izq]);
+        if (der == HIJO_REFERENCIA) escribirVarint(cuerpo, g.segmentoDeRaiz[p->der]);
+
+        if (der == HIJO_SIGUE) pila.apilar(p->der);
+        if (izq == HIJO_SIGUE) pila.apilar(p->izq);
+    }
+
+    string datos;
+    escribirVarint(datos, numero);
+    escribirVarint(datos, personas);
+    datos += cuerpo;
+
+    g.bytesVigentes -= s.largo;
+    s.posicion = inicio + salida.size();
+    s.largo = (uint32_t)(datos.size() + 8);
+    s.sucio = false;
+    g.bytesVigentes += s.largo;
+    agregarBloque(salida, datos);
+
+    r.segmentos++;
+    r.personas += personas;
+}
+
+static string datosDirectorio(const GuardadoIncremental& g) {
+    string d;
+    escribirVarint(d, (uint32_t)g.segmentos.size());
+    for (size_t i = 0; i < g.segmentos.size(); i++) {
+        escribirFijo64(d, g.segmentos[i].posicion);
+        escribirFijo(d, g.segmentos[i].largo, 4);
+    }
+    return d;
+}
+
+// Reescribe el archivo entero y reinicia el seguimiento
+static bool guardarCompleto(GuardadoIncremental& g, Persona* raiz, const string& nombreArchivo,
+                            ResultadoGuardado& r) {
+    g.nombreArchivo = nombreArchivo;
+    g.raiz = raiz;
+    g.segmentoDeRaiz.clear();
+    g.segmentos.clear();
+    g.libres.clear();
+    g.sucios.clear();
+    g.todoSucio = false;
+    g.secuencia = 1;
+    g.bytesVigentes = SEGMENTOS_INICIO_DATOS;
+    r.completo = true;
+
+    // Espacio para los dos encabezados: el segundo queda en cero (inválido)
+    string contenido((size_t)SEGMENTOS_INICIO_DATOS, '\0');
+    uint32_t numeroRaiz = SEGMENTO_NINGUNO;
+    if (raiz != NULL) {
+        numeroRaiz = nuevoSegmento(g, raiz);
+        vector<uint32_t> escribir = particionarSegmento(g, numeroRaiz);
+        for (size_t i = 0; i < escribir.size(); i++)
+            escribirSegmento(g, escribir[i], contenido, 0, r);
+    }
+    uint64_t directorio = contenido.size();
+    agregarBloque(contenido, datosDirectorio(g));
+    contenido.replace(0, SEGMENTOS_TAM_ENCABEZADO, encabezadoSegmentos(g.secuencia, directorio, numeroRaiz));
+    g.bytesArchivo = contenido.size();
+    r.bytes = (long long)contenido.size();
+
+    if (!reemplazarArchivo(nombreArchivo, contenido)) {
+        g.nombreArchivo.clear();   // El archivo no refleja nada de lo anotado
+        g.segmentoDeRaiz.clear();
+        return false;
+    }
+    return true;
+}
+
+// Agrega al final los segmentos sucios y un directorio nuevo, y después
+// confirma con el encabezado que no está en uso
+static bool guardarSegmentosSucios(GuardadoIncremental& g, ResultadoGuardado& r) {
+    uint64_t inicio = g.bytesArchivo;
+    string salida;
+
+    vector<uint32_t> sucios;
+    sucios.swap(g.sucios);
+    for (size_t i = 0; i < sucios.size(); i++) {
+        // Puede haberse liberado (o reutilizado) después de marcarse
+        if (g.segmentos[sucios[i]].raiz == NULL || !g.segmentos[sucios[i]].sucio) continue;
+        vector<uint32_t> escribir = particionarSegmento(g, sucios[i]);
+        for (size_t j = 0; j < escribir.size(); j++)
+            escribirSegmento(g, escribir[j], salida, inicio, r);
+    }
+    uint64_t directorio = inicio + salida.size();
+    agregarBloque(salida, datosDirectorio(g));
+
+    uint64_t secuencia = g.secuencia + 1;
+    string encabezado = encabezadoSegmentos(secuencia, directorio, g.segmentoDeRaiz[g.raiz]);
+
+    // Primero los datos y después el encabezado que los hace vigentes
+    FILE* archivo = fopen(g.nombreArchivo.c_str(), "r+b");
+    bool ok = archivo != NULL
+           && fseek(archivo, (long)inicio, SEEK_SET) == 0
+           && fwrite(salida.data(), 1, salida.size(), archivo) == salida.size()
+           && sincronizarAbierto(archivo)
+           && fseek(archivo, (long)((secuencia % 2) * SEGMENTOS_TAM_ENCABEZADO), SEEK_SET) == 0
+           && fwrite(encabezado.data(), 1, encabezado.size(), archivo) == encabezado.size()
+           && sincronizarAbierto(archivo);
+    if (archivo != NULL && fclose(archivo) != 0) ok = false;
+
+    // Si falló, lo anotado en memoria ya no coincide con el archivo
+    if (!ok) {
+        marcarArbolModificado();
+        return false;
+    }
+    g.secuencia = secuencia;
+    g.bytesArchivo = inicio + salida.size();
+    r.bytes = (long long)(salida.size() + encabezado.size());
+    return true;
+}
+
+bool guardarIncremental(Persona* raiz, string nombreArchivo, ResultadoGuardado* resultado) {
+    GuardadoIncremental& g = guardadoIncremental;
+    ResultadoGuardado r = { false, 0, 0, 0 };
+
+    // Guardado completo si cambió el archivo o el árbol, si hubo cambios
+    // masivos o si la mitad del archivo ya es basura
+    bool completo = g.nombreArchivo != nombreArchivo || g.raiz != raiz || raiz == NULL
+                 || g.todoSucio
+                 || g.bytesArchivo > 2 * g.bytesVigentes + SEGMENTOS_MARGEN_BASURA;
+    bool ok = completo ? guardarCompleto(g, raiz, nombreArchivo, r)
+                       : guardarSegmentosSucios(g, r);
+
+    if (resultado != NULL) *resultado = r;
+    return ok;
+}
+
+// Persona de un segmento ya leída y validada, antes de crearla
+struct FilaIncremental {
+    int id;
+    int edad;
+    string nombre, apellido, fecha, ocupacion, genero;
+    long long hueco;   // Dónde se enlaza: 2 * fila del padre (+ 1 si es derecho)
+};
+
+const long long HUECO_RAIZ = -1;
+
+bool cargarIncremental(string nombreArchivo, Persona*& raiz) {
+    string datos;
+    if (!leerArchivoCompleto(nombreArchivo, datos) || datos.size() < SEGMENTOS_INICIO_DATOS)
+        return false;
+
+    // Encabezado válido con la secuencia más alta
+    bool hayEncabezado = false;
+    uint64_t secuencia = 0, directorio = 0;
+    uint32_t tipo = 0, numeroRaiz = 0;
+    for (size_t e = 0; e < 2; e++) {
+        size_t pos = e * SEGMENTOS_TAM_ENCABEZADO;
+        if (string(datos, pos, 4) != string(SEGMENTOS_MAGICO, 4) ||
+            leerFijoMemoria(datos, pos + 4, 2) != SEGMENTOS_VERSION ||
+            calcularCRC32(datos.data() + pos, 28) != leerFijoMemoria(datos, pos + 28, 4))
+            continue;
+        uint64_t s = leerFijo64Memoria(datos, pos + 8);
+        if (hayEncabezado && s <= secuencia) continue;
+        hayEncabezado = true;
+        secuencia = s;
+        tipo = leerFijoMemoria(datos, pos + 6, 1);
+        directorio = leerFijo64Memoria(datos, pos + 16);
+        numeroRaiz = leerFijoMemoria(datos, pos + 24, 4);
+    }
+    if (!hayEncabezado || tipo > ARBOL_AVL) return false;
+
+    // Directorio
+    string dir;
+    size_t pos = 0;
+    uint32_t cantidad;
+    if (!leerBloque(datos, directorio, dir) || !leerVarintMemoria(dir, pos, cantidad) ||
+        cantidad > (dir.size() - pos) / 12)
+        return false;
+    vector<SegmentoGuardado> segmentos(cantidad);
+    for (uint32_t i = 0; i < cantidad; i++, pos += 12) {
+        SegmentoGuardado s = { NULL, leerFijo64Memoria(dir, pos), leerFijoMemoria(dir, pos + 8, 4), false };
+        segmentos[i] = s;
+    }
+    if (numeroRaiz != SEGMENTO_NINGUNO && numeroRaiz >= cantidad) return false;
+
+    // Primera pasada: leer y validar los segmentos desde la raíz sin crear
+    // personas, así un archivo dañado no toca el árbol actual ni los índices.
+    // Un hueco se anota como 2 * fila (hijo izquierdo), 2 * fila + 1 (derecho)
+    // o HUECO_RAIZ; cada referencia lo deja pendiente junto con el segmento
+    // que lo llena.
+    struct Referencia {
+        long long hueco;
+        uint32_t numero;
+    };
+    vector<FilaIncremental> filas;
+    vector<long long> primeraFila(cantidad, -1);   // Fila raíz de cada segmento
+    unordered_set<int> ids;
+    vector<Referencia> pendientes;
+    if (numeroRaiz != SEGMENTO_NINGUNO) {
+        Referencia r = { HUECO_RAIZ, numeroRaiz };
+        pendientes.push_back(r);
+    }
+    bool valido = true;
+
+    while (!pendientes.empty() && valido) {
+        Referencia ref = pendientes.back();
+        pendientes.pop_back();
+
+        // Cada segmento se usa una sola vez
+        const SegmentoGuardado& s = segmentos[ref.numero];
+        string seg;
+        size_t p = 0;
+        uint32_t numero, personas;
+        valido = primeraFila[ref.numero] < 0 && s.largo >= 8 && leerBloque(datos, s.posicion, seg)
+              && s.largo == seg.size() + 8
+              && leerVarintMemoria(seg, p, numero) && numero == ref.numero
+              && leerVarintMemoria(seg, p, personas) && personas > 0;
+        if (!valido) break;
+        primeraFila[ref.numero] = (long long)filas.size();
+
+        Pila<long long> huecos;
+        huecos.apilar(ref.hueco);
+        for (uint32_t n = 0; n < personas && valido; n++) {
+            FilaIncremental f;
+            uint32_t id, edad;
+            valido = p < seg.size() && !huecos.vacia();
+            if (!valido) break;
+            uint8_t enlaces = (uint8_t)seg[p++];
+            uint8_t izq = enlaces & 3, der = enlaces >> 2;
+            valido = izq <= HIJO_REFERENCIA && der <= HIJO_REFERENCIA
+                  && leerVarintMemoria(seg, p, id) && leerVarintMemoria(seg, p, edad)
+                  && leerCadenaMemoria(seg, p, f.nombre) && leerCadenaMemoria(seg, p, f.apellido)
+                  && leerCadenaMemoria(seg, p, f.fecha) && leerCadenaMemoria(seg, p, f.ocupacion)
+                  && leerCadenaMemoria(seg, p, f.genero)
+                  && ids.insert(deszigzag(id)).second;
+            if (!valido) break;
+
+            long long fila = (long long)filas.size();
+            f.id = deszigzag(id);
+            f.edad = (int)edad;
+            f.hueco = huecos.desapilar();
+            filas.push_back(f);
+
+            uint32_t hijo;
+            if (izq == HIJO_REFERENCIA) {
+                valido = leerVarintMemoria(seg, p, hijo) && hijo < cantidad;
+                Referencia r = { 2 * fila, hijo };
+                if (valido) pendientes.push_back(r);
+            }
+            if (der == HIJO_REFERENCIA && valido) {
+                valido = leerVarintMemoria(seg, p, hijo) && hijo < cantidad;
+                Referencia r = { 2 * fila + 1, hijo };
+                if (valido) pendientes.push_back(r);
+            }
+
+            // El hueco izquierdo se llena primero, así que se apila último
+            if (der == HIJO_SIGUE) huecos.apilar(2 * fila + 1);
+            if (izq == HIJO_SIGUE) huecos.apilar(2 * fila);
+        }
+        valido = valido && huecos.vacia() && p == seg.size();
+    }
+    if (!valido) return false;
+
+    // Segunda pasada: el archivo es válido, recién ahora se reemplaza el árbol
+    limpiarArbolCompleto(raiz);
+    Persona* nueva = NULL;
+    vector<Persona*> creadas(filas.size());
+    for (size_t n = 0; n < filas.size(); n++) {
+        const FilaIncremental& f = filas[n];
+        Persona* persona = crearPersona(f.id, f.nombre, f.apellido, f.edad,
+                                        f.fecha, f.ocupacion, f.genero);
+        creadas[n] = persona;
+        if (f.hueco == HUECO_RAIZ) nueva = persona;
+        else if (f.hueco % 2 == 0) creadas[f.hueco / 2]->izq = persona;
+        else creadas[f.hueco / 2]->der = persona;
+    }
+    for (uint32_t i = 0; i < cantidad; i++)
+        if (primeraFila[i] >= 0) segmentos[i].raiz = creadas[primeraFila[i]];
+
+    recalcularAgregados(nueva);   // Padres, alturas y estadísticas
+    tipoArbol = (TipoArbol)tipo;
+    raiz = nueva;
+
+    // Empezar a seguir este archivo: los segmentos que no se alcanzaron
+    // desde la raíz quedan libres
+    GuardadoIncremental& g = guardadoIncremental;
+    g.nombreArchivo = nombreArchivo;
+    g.raiz = nueva;
+    g.segmentoDeRaiz.clear();
+    g.libres.clear();
+    g.sucios.clear();
+    g.todoSucio = false;
+    g.secuencia = secuencia;
+    g.bytesArchivo = directorio + 8 + dir.size();
+    g.bytesVigentes = SEGMENTOS_INICIO_DATOS;
+    for (uint32_t i = 0; i < cantidad; i++) {
+        if (segmentos[i].raiz == NULL) {
+            SegmentoGuardado libre = { NULL, 0, 0, false };
+            segmentos[i] = libre;
+            g.libres.push_back(i);
+        } else {
+            g.segmentoDeRaiz[segmentos[i].raiz] = i;
+            g.bytesVigentes += segmentos[i].largo;
+        }
+    }
+    g.segmentos.swap(segmentos);
+    return true;
+}
+
+// Versiones sobre el árbol de punteros
+int contarNodos(Persona* raiz)          { return contarNodos(VistaPersonas(raiz)); }
+
+int calcularAltura(Persona* raiz)       { return calcularAltura(VistaPersonas(raiz)); }
+
+// ------------------------------------------------------
+// Pool de hilos con robo de tareas
+// ------------------------------------------------------
+
+// Cola de un hilo: el dueño usa el final (LIFO, datos aún en caché) y los
+// ladrones el principio (las tareas más viejas suelen ser las más grandes)
+struct ColaTareas {
+    mutex cerrojo;
+    deque<function<void()> > tareas;
+};
+
+struct PoolHilos {
+    vector<thread> hilos;
+    vector<ColaTareas*> colas;      // Una por hilo del pool y al final la de hilos externos
+    atomic<int> encoladas;          // Tareas esperando en alguna cola
+    atomic<bool> terminar;
+    atomic<unsigned> activos;       // Hilos que trabajan (ver limitarHilosDelPool)
+    mutex cerrojoDormir;
+    condition_variable hayTareas;       // Despierta a los hilos sin trabajo
+    condition_variable grupoTerminado;  // Despierta a los que esperan un grupo
+    condition_variable cambioLimite;    // Despierta a los hilos fuera del límite
+
+    PoolHilos();
+    ~PoolHilos();
+};
+
+// Cola propia del hilo actual (-1 si no pertenece al pool)
+static thread_local int colaDelHilo = -1;
+
+// Saca una tarea de la cola propia o, si está vacía, la roba de otra
+static bool tomarTarea(PoolHilos& pool, int propia, function<void()>& tarea) {
+    size_t n = pool.colas.size();
+    {
+        ColaTareas& cola = *pool.colas[propia];
+        lock_guard<mutex> bloqueo(cola.cerrojo);
+        if (!cola.tareas.empty()) {
+            tarea = move(cola.tareas.back());
+            cola.tareas.pop_back();
+            pool.encoladas--;
+            return true;
+        }
+    }
+    for (size_t k = 1; k < n; k++) {
+        ColaTareas& victima = *pool.colas[(propia + k) % n];
+        lock_guard<mutex> bloqueo(victima.cerrojo);
+        if (!victima.tareas.empty()) {
+            tarea = move(victima.tareas.front());
+            victima.tareas.pop_front();
+            pool.encoladas--;
+            return true;
+        }
+    }
+    return false;
+}
+
+// true si el hilo del pool con esa cola está dentro del límite de hilos
+// (el hilo que espera un grupo cuenta como uno)
+static bool hiloActivo(const PoolHilos& pool, int propia) {
+    return (unsigned)propia + 1 < pool.activos;
+}
+
+// Ciclo de cada hilo del pool: ejecutar, robar o dormir hasta que haya tareas.
+// Los hilos fuera del límite duermen aparte para no quedarse con el aviso
+// de una tarea nueva que otro hilo sí podría tomar.
+static void trabajarEnPool(PoolHilos* pool, int propia) {
+    colaDelHilo = propia;
+    function<void()> tarea;
+    while (!pool->terminar) {
+        if (!hiloActivo(*pool, propia)) {
+            unique_lock<mutex> bloqueo(pool->cerrojoDormir);
+            pool->cambioLimite.wait(bloqueo, [pool, propia]() {
+                return hiloActivo(*pool, propia) || pool->terminar;
+            });
+            continue;
+        }
+        if (tomarTarea(*pool, propia, tarea)) {
+            tarea();
+            continue;
+        }
+        unique_lock<mutex> bloqueo(pool->cerrojoDormir);
+        pool->hayTareas.wait(bloqueo, [pool, propia]() {
+            return pool->encoladas > 0 || pool->terminar || !hiloActivo(*pool, propia);
+        });
+    }
+}
+
+PoolHilos::PoolHilos() : encoladas(0), terminar(false), activos(1) {
+    // El hilo que espera un grupo también trabaja: se lanza uno menos
+    unsigned total = thread::hardware_concurrency();
+    unsigned trabajadores = (total >= 2) ? total - 1 : 0;
+    for (unsigned i = 0; i <= trabajadores; i++)
+        colas.push_back(new ColaTareas());
+    activos = trabajadores + 1;
+    for (unsigned i = 0; i < trabajadores; i++)
+        hilos.push_back(thread(trabajarEnPool, this, (int)i));
+}
+
+PoolHilos::~PoolHilos() {
+    {
+        lock_guard<mutex> bloqueo(cerrojoDormir);
+        terminar = true;
+    }
+    hayTareas.notify_all();
+    cambioLimite.notify_all();
+    for (size_t i = 0; i < hilos.size(); i++) hilos[i].join();
+    for (size_t i = 0; i < colas.size(); i++) delete colas[i];
+}
+
+// El pool se crea la primera vez que se usa
+static PoolHilos& poolHilos() {
+    static PoolHilos pool;
+    return pool;
+}
+
+unsigned hilosDelPool() {
+    return poolHilos().activos;
+}
+
+unsigned limitarHilosDelPool(unsigned hilos) {
+    PoolHilos& pool = poolHilos();
+    unsigned maximo = (unsigned)pool.hilos.size() + 1;
+    {
+        lock_guard<mutex> bloqueo(pool.cerrojoDormir);
+        pool.activos = (hilos == 0 || hilos > maximo) ? maximo : hilos;
+    }
+    pool.cambioLimite.notify_all();
+    pool.hayTareas.notify_all();
+    return pool.activos;
+}
+
+void lanzarTarea(GrupoTareas& grupo, function<void()> tarea) {
+    PoolHilos& pool = poolHilos();
+    int propia = (colaDelHilo >= 0) ? colaDelHilo : (int)pool.colas.size() - 1;
+
+    grupo.pendientes++;
+    GrupoTareas* g = &grupo;
+    PoolHilos* p = &pool;
+    {
+        ColaTareas& cola = *pool.colas[propia];
+        lock_guard<mutex> bloqueo(cola.cerrojo);
+        cola.tareas.push_back([g, p, tarea]() {
+            tarea();
+            // Después de esto el grupo puede dejar de existir: solo se usa el pool
+            if (--g->pendientes == 0) {
+                lock_guard<mutex> bloqueo(p->cerrojoDormir);
+                p->grupoTerminado.notify_all();
+            }
+        });
+    }
+    {
+        // Con el cerrojo tomado ningún hilo puede quedarse dormido sin ver la tarea
+        lock_guard<mutex> bloqueo(pool.cerrojoDormir);
+        pool.encoladas++;
+    }
+    pool.hayTareas.notify_one();
+    pool.grupoTerminado.notify_all();   // Los que esperan un grupo también pueden tomarla
+}
+
+// Vueltas sin encontrar tareas antes de dormir esperando el grupo
+const int VUELTAS_ANTES_DE_DORMIR = 64;
+
+void esperarGrupo(GrupoTareas& grupo) {
+    PoolHilos& pool = poolHilos();
+    int propia = (colaDelHilo >= 0) ? colaDelHilo : (int)pool.colas.size() - 1;
+    function<void()> tarea;
+    int vueltas = 0;
+    while (grupo.pendientes > 0) {
+        if (tomarTarea(pool, propia, tarea)) {
+            tarea();
+            vueltas = 0;
+            continue;
+        }
+        if (++vueltas < VUELTAS_ANTES_DE_DORMIR) {
+            this_thread::yield();
+            continue;
+        }
+
+        // Nada para robar: las tareas del grupo ya están corriendo en otros
+        // hilos. Dormir hasta que el grupo termine o aparezca trabajo nuevo.
+        unique_lock<mutex> bloqueo(pool.cerrojoDormir);
+        pool.grupoTerminado.wait(bloqueo, [&grupo, &pool]() {
+            return grupo.pendientes == 0 || pool.encoladas > 0;
+        });
+        vueltas = 0;
+    }
+}
+
+// ---------------------
+// Acumuladores de los recorridos en paralelo
+// ---------------------
+
+struct AcumuladorConteo {
+    long long total;
+    void visitar(Persona*, int)                { total++; }
+    void unir(const AcumuladorConteo& otro)    { total += otro.total; }
+    bool terminado() const                     { return false; }
+};
+
+struct AcumuladorAltura {
+    int altura;
+    void visitar(Persona*, int profundidad)    { if (profundidad > altura) altura = profundidad; }
+    void unir(const AcumuladorAltura& otro)    { if (otro.altura > altura) altura = otro.altura; }
+    bool terminado() const                     { return false; }
+};
+
+struct AcumuladorEdades {
+    ResumenEdades r;
+
+    void visitar(Persona* p, int) {
+        r.total++;
+        r.sumaEdades += p->edad;
+        if (p->edad < r.edadMinima) r.edadMinima = p->edad;
+        if (p->edad > r.edadMaxima) r.edadMaxima = p->edad;
+        r.generos[codigoGenero(p->genero)]++;
+    }
+    void unir(const AcumuladorEdades& otro) {
+        r.total += otro.r.total;
+        r.sumaEdades += otro.r.sumaEdades;
+        r.edadMinima = min(r.edadMinima, otro.r.edadMinima);
+        r.edadMaxima = max(r.edadMaxima, otro.r.edadMaxima);
+        for (int g = 0; g < 3; g++) r.generos[g] += otro.r.generos[g];
+    }
+    bool terminado() const { return false; }
+};
+
+long long contarEnParalelo(Persona* raiz) {
+    AcumuladorConteo inicial = { 0 };
+    return recorrerEnParalelo(raiz, inicial).total;
+}
+
+int alturaEnParalelo(Persona* raiz) {
+    AcumuladorAltura inicial = { 0 };
+    return recorrerEnParalelo(raiz, inicial).altura;
+}
+
+ResumenEdades edadesEnParalelo(Persona* raiz) {
+    AcumuladorEdades inicial = { { 0, 0, INT_MAX, INT_MIN, { 0, 0, 0 } } };
+    ResumenEdades r = recorrerEnParalelo(raiz, inicial).r;
+    if (r.total == 0) r.edadMinima = r.edadMaxima = 0;
+    return r;
+}
+
+// ------------------------------------------------------
+// Imagen de solo lectura (.ari) para abrir con mmap
+// ------------------------------------------------------
+
+const char     IMAGEN_MAGICO[4] = { 'A', 'R', 'B', 'I' };
+const uint16_t IMAGEN_VERSION   = 1;
+
+// Agrega una cadena al bloque (sin repetir) y devuelve su referencia
+static CadenaImagen agregarCadenaImagen(string& bloque, unordered_map<string, uint32_t>& vistas,
+                                        const string& texto) {
+    CadenaImagen c;
+    c.largo = (uint32_t)texto.size();
+
+    unordered_map<string, uint32_t>::iterator it = vistas.find(texto);
+    if (it != vistas.end()) {
+        c.offset = it->second;
+    } else {
+        c.offset = (uint32_t)bloque.size();
+        vistas[texto] = c.offset;
+        bloque += texto;
+    }
+    return c;
+}
+
+// Ordena las entradas del índice por ID
+static bool compararEntradaOrden(const EntradaOrdenImagen& a, const EntradaOrdenImagen& b) {
+    return a.id < b.id;
+}
+
+// Guarda el árbol como imagen plana lista para mapear en memoria
+bool guardarImagen(Persona* raiz, string nombreArchivo) {
+    vector<NodoImagen> nodos;
+    vector<EntradaOrdenImagen> orden;
+    unordered_map<string, uint32_t> vistas;
+    string cadenas;
+
+    EncabezadoImagen enc;
+    memset(&enc, 0, sizeof(enc));
+    memcpy(enc.magico, IMAGEN_MAGICO, 4);
+    enc.version = IMAGEN_VERSION;
+    enc.tipoArbol = (uint8_t)tipoArbol;
+
+    // Pre-orden: cada marco sabe qué campo del padre debe apuntar al nodo
+    struct Marco {
+        Persona* persona;
+        uint32_t padre;
+        bool esIzq;
+    };
+    Pila<Marco> pila;
+    if (raiz != NULL) {
+        Marco inicio = { raiz, IMAGEN_NINGUNO, false };
+        pila.apilar(inicio);
+    }
+
+    while (!pila.vacia()) {
+        Marco m = pila.desapilar();
+        Persona* p = m.persona;
+        uint32_t indice = (uint32_t)nodos.size();
+
+        NodoImagen n;
+        n.id = p->id;
+        n.edad = p->edad;
+        n.izq = n.der = IMAGEN_NINGUNO;
+        n.padre = m.padre;
+        n.nombre          = agregarCadenaImagen(cadenas, vistas, p->nombre);
+        n.apellido        = agregarCadenaImagen(cadenas, vistas, p->apellido);
+        n.fechaNacimiento = agregarCadenaImagen(cadenas, vistas, p->fechaNacimiento);
+        n.ocupacion       = agregarCadenaImagen(cadenas, vistas, p->ocupacion);
+        n.genero          = agregarCadenaImagen(cadenas, vistas, p->genero);
+        nodos.push_back(n);
+
+        // Enlazar desde el padre
+        if (m.padre != IMAGEN_NINGUNO) {
+            if (m.esIzq) nodos[m.padre].izq = indice;
+            else         nodos[m.padre].der = indice;
+        }
+
+        EntradaOrdenImagen e = { p->id, indice };
+        orden.push_back(e);
+
+        // Estadísticas del encabezado
+        enc.generos[codigoGenero(p->genero)]++;
+        enc.sumaEdades += (uint64_t)p->edad;
+
+        if (p->der != NULL) { Marco d = { p->der, indice, false }; pila.apilar(d); }
+        if (p->izq != NULL) { Marco i = { p->izq, indice, true };  pila.apilar(i); }
+    }
+
+    sort(orden.begin(), orden.end(), compararEntradaOrden);
+
+    // Calcular la ubicación de cada sección
+    uint64_t tamTotal = sizeof(EncabezadoImagen)
+                      + (uint64_t)nodos.size() * sizeof(NodoImagen)
+                      + (uint64_t)orden.size() * sizeof(EntradaOrdenImagen)
+                      + cadenas.size();
+    if (tamTotal > 0xFFFFFFFFull) return false;   // No cabe en offsets de 32 bits
+
+    enc.nodos = (uint32_t)nodos.size();
+    enc.altura = (uint32_t)calcularAltura(raiz);
+    enc.offsetNodos = sizeof(EncabezadoImagen);
+    enc.offsetOrden = enc.offsetNodos + (uint32_t)(nodos.size() * sizeof(NodoImagen));
+    enc.offsetCadenas = enc.offsetOrden + (uint32_t)(orden.size() * sizeof(EntradaOrdenImagen));
+    enc.tamCadenas = (uint32_t)cadenas.size();
+
+    ofstream archivo(nombreArchivo.c_str(), ios::binary);
+    if (!archivo.is_open()) return false;
+
+    archivo.write((const char*)&enc, sizeof(enc));
+    if (!nodos.empty()) {
+        archivo.write((const char*)&nodos[0], nodos.size() * sizeof(NodoImagen));
+        archivo.write((const char*)&orden[0], orden.size() * sizeof(EntradaOrdenImagen));
+    }
+    archivo.write(cadenas.data(), cadenas.size());
+    archivo.close();
+    return !archivo.fail();
+}
+
+// Libera el mapeo (o el buffer en Windows) de una imagen abierta
+void cerrarImagen(ImagenArbol& img) {
+    if (img.base != NULL) {
+    #ifdef _WIN32
+        delete[] img.base;
+    #else
+        munmap((void*)img.base, img.tam);
+    #endif
+    }
+    img.base = NULL;
+    img.tam = 0;
+}
+
+// Mapea el archivo en memoria y valida que sus secciones sean coherentes
+bool abrirImagen(string nombreArchivo, ImagenArbol& img) {
+    img.base = NULL;
+    img.tam = 0;
+
+#ifdef _WIN32
+    // Sin mmap POSIX: se lee el archivo completo una sola vez
+    ifstream archivo(nombreArchivo.c_str(), ios::binary | ios::ate);
+    if (!archivo.is_open()) return false;
+    img.tam = (size_t)archivo.tellg();
+    unsigned char* datos = new unsigned char[img.tam > 0 ? img.tam : 1];
+    archivo.seekg(0);
+    archivo.read((char*)datos, img.tam);
+    img.base = datos;
+#else
+    int fd = open(nombreArchivo.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(EncabezadoImagen)) {
+        close(fd);
+        return false;
+    }
+    img.tam = (size_t)info.st_size;
+
+    void* mapa = mmap(NULL, img.tam, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);   // El mapeo sigue válido después de cerrar el descriptor
+    if (mapa == MAP_FAILED) return false;
+    img.base = (const unsigned char*)mapa;
+#endif
+
+    // Validar encabezado y límites de cada sección
+    img.enc = (const EncabezadoImagen*)img.base;
+    const EncabezadoImagen& e = *img.enc;
+    bool valido = img.tam >= sizeof(EncabezadoImagen)
+        && memcmp(e.magico, IMAGEN_MAGICO, 4) == 0
+        && e.version == IMAGEN_VERSION
+        && e.offsetNodos == sizeof(EncabezadoImagen)
+        && e.offsetOrden == e.offsetNodos + (uint64_t)e.nodos * sizeof(NodoImagen)
+        && e.offsetCadenas == e.offsetOrden + (uint64_t)e.nodos * sizeof(EntradaOrdenImagen)
+        && (uint64_t)e.offsetCadenas + e.tamCadenas <= img.tam;
+    if (!valido) {
+        cerrarImagen(img);
+        return false;
+    }
+
+    img.nodos   = (const NodoImagen*)(img.base + e.offsetNodos);
+    img.orden   = (const EntradaOrdenImagen*)(img.base + e.offsetOrden);
+    img.cadenas = (const char*)(img.base + e.offsetCadenas);
+    return true;
+}
+
+// Busca un ID con búsqueda binaria sobre el índice ordenado
+uint32_t buscarEnImagen(const ImagenArbol& img, int id) {
+    uint32_t bajo = 0, alto = img.enc->nodos;
+    while (bajo < alto) {
+        uint32_t medio = bajo + (alto - bajo) / 2;
+        if (img.orden[medio].id < id) bajo = medio + 1;
+        else alto = medio;
+    }
+    if (bajo < img.enc->nodos && img.orden[bajo].id == id
+        && img.orden[bajo].nodo < img.enc->nodos)
+        return img.orden[bajo].nodo;
+    return IMAGEN_NINGUNO;
+}
+
+// ------------------------------------------------------
+// Importación masiva desde CSV/TSV
+// ------------------------------------------------------
+
+const int CSV_CAMPOS = 9;
+const size_t CSV_TAM_BLOQUE = 1 << 20;   // Se lee el archivo de a 1 MB
+const size_t CSV_MAX_ERRORES = 10;       // Errores detallados a conservar
+
+// Campo de una línea: apunta al buffer de lectura, no copia el texto
+struct CampoCSV {
+    const char* inicio;
+    size_t largo;
+};
+
+// Fila ya validada que espera ser enlazada con su padre
+struct EnlacePendiente {
+    Persona* hijo;
+    int idPadre;
+    char lado;
+    long linea;
+};
+
+// Registra un error (solo se guardan los primeros para no llenar memoria)
+static void registrarErrorCSV(ResultadoImportacion& res, long linea, const string& motivo) {
+    res.rechazadas++;
+    if (res.errores.size() < CSV_MAX_ERRORES)
+        res.errores.push_back("Línea " + to_string(linea) + ": " + motivo);
+}
+
+// Convierte un campo a entero sin crear cadenas; false si no es numérico
+static bool campoAEntero(CampoCSV c, long long& valor) {
+    size_t i = 0;
+    bool negativo = false;
+    if (c.largo > 0 && (c.inicio[0] == '-' || c.inicio[0] == '+')) {
+        negativo = c.inicio[0] == '-';
+        i = 1;
+    }
+    if (i == c.largo || c.largo - i > 10) return false;
+
+    valor = 0;
+    for (; i < c.largo; i++) {
+        if (c.inicio[i] < '0' || c.inicio[i] > '9') return false;
+        valor = valor * 10 + (c.inicio[i] - '0');
+    }
+    if (negativo) valor = -valor;
+    return valor >= INT32_MIN && valor <= INT32_MAX;
+}
+
+// Divide una línea en campos; devuelve cuántos encontró
+static int separarCampos(const char* linea, size_t largo, char separador, CampoCSV campos[CSV_CAMPOS]) {
+    int n = 0;
+    size_t i = 0;
+    while (n < CSV_CAMPOS) {
+        CampoCSV c;
+        if (i < largo && linea[i] == '"') {
+            // Campo entre comillas: termina en la comilla de cierre
+            size_t fin = i + 1;
+            while (fin < largo && linea[fin] != '"') fin++;
+            c.inicio = linea + i + 1;
+            c.largo = fin - (i + 1);
+            i = fin + 1;
+            while (i < largo && linea[i] != separador) i++;
+        } else {
+            size_t fin = i;
+            while (fin < largo && linea[fin] != separador) fin++;
+            c.inicio = linea + i;
+            c.largo = fin - i;
+            i = fin;
+        }
+        campos[n++] = c;
+        if (i >= largo) break;
+        i++;   // Saltar el separador
+    }
+    return (i < largo) ? CSV_CAMPOS + 1 : n;   // Campos de más: línea inválida
+}
+
+// Valida una línea y crea la persona (sin enlazarla todavía)
+static void procesarLineaCSV(const char* linea, size_t largo, long numero, char separador,
+                             vector<EnlacePendiente>& pendientes, ResultadoImportacion& res) {
+    CampoCSV c[CSV_CAMPOS];
+    if (separarCampos(linea, largo, separador, c) != CSV_CAMPOS) {
+        registrarErrorCSV(res, numero, "se esperaban 9 campos");
+        return;
+    }
+
+    long long id, idPadre = 0, edad;
+    if (!campoAEntero(c[0], id)) {
+        registrarErrorCSV(res, numero, "ID inválido");
+        return;
+    }
+    if (c[1].largo > 0 && !campoAEntero(c[1], idPadre)) {
+        registrarErrorCSV(res, numero, "ID del padre inválido");
+        return;
+    }
+
+    // Lado: vacío solo para la raíz
+    char lado = (c[2].largo == 1) ? c[2].inicio[0] : '\0';
+    if (c[2].largo > 1 || (lado != '\0' && lado != 'I' && lado != 'i' && lado != 'D' && lado != 'd')) {
+        registrarErrorCSV(res, numero, "lado inválido (use I o D)");
+        return;
+    }
+    if ((idPadre == 0) != (lado == '\0')) {
+        registrarErrorCSV(res, numero, "idPadre y lado deben indicarse juntos");
+        return;
+    }
+    if (idPadre == 0 && id <= 0) {
+        registrarErrorCSV(res, numero, "el ID de la raíz debe ser positivo");
+        return;
+    }
+
+    // Mismas reglas que ingresarPersonaCompleta
+    if (!campoAEntero(c[5], edad) || !edadValida((int)edad)) {
+        registrarErrorCSV(res, numero, "edad inválida (0 a 120)");
+        return;
+    }
+    string genero(c[8].inicio, c[8].largo);
+    if (!generoValido(genero)) {
+        registrarErrorCSV(res, numero, "género inválido");
+        return;
+    }
+    if (indicePorID.find((int)id) != indicePorID.end()) {
+        registrarErrorCSV(res, numero, "ID repetido");
+        return;
+    }
+
+    Persona* p = crearPersona((int)id, string(c[3].inicio, c[3].largo),
+                              string(c[4].inicio, c[4].largo), (int)edad,
+                              string(c[6].inicio, c[6].largo),
+                              string(c[7].inicio, c[7].largo), genero);
+    EnlacePendiente e = { p, (int)idPadre, lado, numero };
+    pendientes.push_back(e);
+}
+
+// Importa personas desde un archivo CSV/TSV. Si el árbol está vacío el
+// archivo debe traer una raíz; si no, todas las filas cuelgan del árbol actual.
+// Los hijos pueden aparecer antes que sus padres en el archivo.
+bool importarCSV(string nombreArchivo, Persona*& raiz, ResultadoImportacion& res) {
+    res.lineas = res.importadas = res.rechazadas = 0;
+    res.errores.clear();
+
+    ifstream archivo(nombreArchivo.c_str(), ios::binary);
+    if (!archivo.is_open()) return false;
+
+    // Primera etapa: leer por bloques, cortar líneas y crear las personas
+    vector<EnlacePendiente> pendientes;
+    vector<char> buffer(CSV_TAM_BLOQUE);
+    size_t ocupado = 0;      // Bytes válidos en el buffer
+    long numeroLinea = 0;
+    char separador = 0;      // Se decide con la primera línea
+    bool finArchivo = false;
+
+    while (!finArchivo || ocupado > 0) {
+        // Rellenar el buffer después del resto de la línea anterior
+        if (!finArchivo) {
+            if (ocupado == buffer.size()) buffer.resize(buffer.size() * 2);  // Línea muy larga
+            archivo.read(&buffer[ocupado], buffer.size() - ocupado);
+            ocupado += (size_t)archivo.gcount();
+            finArchivo = archivo.eof() || archivo.gcount() == 0;
+        }
+
+        // Procesar todas las líneas completas del buffer
+        size_t inicio = 0;
+        while (true) {
+            const char* base = &buffer[0];
+            const char* salto = (const char*)memchr(base + inicio, '\n', ocupado - inicio);
+            size_t fin;
+            if (salto != NULL) fin = salto - base;
+            else if (finArchivo && inicio < ocupado) fin = ocupado;   // Última línea sin salto
+            else break;
+
+            size_t largo = fin - inicio;
+            if (largo > 0 && base[inicio + largo - 1] == '\r') largo--;
+            numeroLinea++;
+
+            if (separador == 0) {
+                separador = memchr(base + inicio, '\t', largo) ? '\t' : ',';
+
+                // Saltar el encabezado si el primer campo no es un número
+                CampoCSV c[CSV_CAMPOS];
+                long long dummy;
+                separarCampos(base + inicio, largo, separador, c);
+                if (!campoAEntero(c[0], dummy)) {
+                    inicio = fin + 1;
+                    if (inicio >= ocupado) break;   // Archivo con solo el encabezado
+                    continue;
+                }
+            }
+
+            if (largo > 0) {
+                res.lineas++;
+                procesarLineaCSV(base + inicio, largo, numeroLinea, separador, pendientes, res);
+            }
+            inicio = fin + 1;
+            if (inicio >= ocupado) break;
+        }
+
+        // Mover el resto incompleto al comienzo del buffer
+        if (inicio >= ocupado) {
+            ocupado = 0;
+        } else if (inicio > 0) {
+            memmove(&buffer[0], &buffer[inicio], ocupado - inicio);
+            ocupado -= inicio;
+        }
+        if (finArchivo && ocupado == 0) break;
+    }
+
+    // Segunda etapa: enlazar cada persona con su padre usando el índice hash
+    Persona* nuevaRaiz = raiz;
+    vector<bool> rechazada(pendientes.size(), false);
+    for (size_t i = 0; i < pendientes.size(); i++) {
+        EnlacePendiente& e = pendientes[i];
+        e.hijo->altura = 0;   // Marca de "aún no alcanzada desde la raíz"
+
+        if (e.idPadre == 0) {
+            if (nuevaRaiz != NULL) {
+                registrarErrorCSV(res, e.linea, "el árbol ya tiene raíz");
+                rechazada[i] = true;
+            } else {
+                nuevaRaiz = e.hijo;
+            }
+            continue;
+        }
+
+        unordered_map<int, Persona*>::iterator it = indicePorID.find(e.idPadre);
+        Persona* padre = (it == indicePorID.end()) ? NULL : it->second;
+
+        if (padre == NULL || padre == e.hijo) {
+            registrarErrorCSV(res, e.linea, "no existe el padre " + to_string(e.idPadre));
+            rechazada[i] = true;
+            continue;
+        }
+
+        Persona*& hueco = (e.lado == 'I' || e.lado == 'i') ? padre->izq : padre->der;
+        if (hueco != NULL) {
+            registrarErrorCSV(res, e.linea, "ese lado del padre ya está ocupado");
+            rechazada[i] = true;
+            continue;
+        }
+        hueco = e.hijo;
+        e.hijo->padre = padre;
+    }
+
+    // Padres, agregados y marca de alcanzadas en un solo recorrido
+    recalcularAgregados(nuevaRaiz);
+
+    // Las filas que no quedaron conectadas a la raíz (padre rechazado o ciclo)
+    // se liberan una por una: nunca apuntan a nodos alcanzados
+    for (size_t i = 0; i < pendientes.size(); i++) {
+        if (pendientes[i].hijo->altura != 0) {
+            res.importadas++;
+            continue;
+        }
+        if (!rechazada[i])
+            registrarErrorCSV(res, pendientes[i].linea, "no quedó conectada a la raíz");
+        liberarPersona(pendientes[i].hijo);
+    }
+
+    if (res.importadas > 0) tipoArbol = ARBOL_GENEALOGICO;
+    raiz = nuevaRaiz;
+    return true;
+}
+
+// ------------------------------------------------------
+// Acceso concurrente
+// ------------------------------------------------------
+
+void bloquearLectura(CerrojoLectoresEscritor& c) {
+    unique_lock<mutex> bloqueo(c.cerrojo);
+    c.puedeLeer.wait(bloqueo, [&c]() { return !c.escribiendo && c.escritoresEsperando == 0; });
+    c.lectores++;
+}
+
+void desbloquearLectura(CerrojoLectoresEscritor& c) {
+    lock_guard<mutex> bloqueo(c.cerrojo);
+    if (--c.lectores == 0 && c.escritoresEsperando > 0)
+        c.puedeEscribir.notify_one();
+}
+
+void bloquearEscritura(CerrojoLectoresEscritor& c) {
+    unique_lock<mutex> bloqueo(c.cerrojo);
+    c.escritoresEsperando++;
+    c.puedeEscribir.wait(bloqueo, [&c]() { return !c.escribiendo && c.lectores == 0; });
+    c.escritoresEsperando--;
+    c.escribiendo = true;
+}
+
+void desbloquearEscritura(CerrojoLectoresEscritor& c) {
+    lock_guard<mutex> bloqueo(c.cerrojo);
+    c.escribiendo = false;
+    // Otro escritor en cola tiene prioridad; si no hay, entran todos los lectores
+    if (c.escritoresEsperando > 0) c.puedeEscribir.notify_one();
+    else c.puedeLeer.notify_all();
+}
+
+bool copiarPersona(ArbolCompartido& a, int id, DatosPersona& datos) {
+    return leerPersona(a, id, [&datos](const Persona* p) { datos = datosDePersona(p); });
+}
+
+// Crea la persona de unos datos (se llama con el cerrojo exclusivo tomado)
+static Persona* personaDeDatos(const DatosPersona& d) {
+    return crearPersona(d.id, d.nombre, d.apellido, d.edad,
+                        d.fechaNacimiento, d.ocupacion, d.genero);
+}
+
+EstadoArbol crearRaizCompartida(ArbolCompartido& a, const DatosPersona& datos) {
+    BloqueoEscritura bloqueo(a.cerrojo);
+    if (a.raiz != NULL) eliminarArbol(a.raiz);
+    a.raiz = personaDeDatos(datos);
+    tipoArbol = ARBOL_GENEALOGICO;
+    return ESTADO_OK;
+}
+
+EstadoArbol insertarHijoCompartido(ArbolCompartido& a, int idPadre,
+                                   const DatosPersona& datos, char lado) {
+    BloqueoEscritura bloqueo(a.cerrojo);
+    if (buscar(a.raiz, datos.id)) return ESTADO_ID_DUPLICADO;
+    Persona* nuevo = personaDeDatos(datos);
+    EstadoArbol estado = insertarHijo(a.raiz, idPadre, nuevo, lado);
+    if (estado != ESTADO_OK && estado != ESTADO_REEMPLAZADO) liberarPersona(nuevo);
+    return estado;
+}
+
+EstadoArbol insertarABBCompartido(ArbolCompartido& a, const DatosPersona& datos) {
+    BloqueoEscritura bloqueo(a.cerrojo);
+    if (buscar(a.raiz, datos.id)) return ESTADO_ID_DUPLICADO;
+    EstadoArbol estado = ESTADO_OK;
+    a.raiz = insertarABB(a.raiz, personaDeDatos(datos), &estado);
+    return estado;
+}
+
+EstadoArbol eliminarPersonaCompartida(ArbolCompartido& a, int id) {
+    BloqueoEscritura bloqueo(a.cerrojo);
+    int liberadas = 0;
+    a.raiz = eliminarPersona(a.raiz, id, &liberadas);
+    return (liberadas > 0) ? ESTADO_OK : ESTADO_NO_EXISTE;
+}
+
+// ------------------------------------------------------
+// Versiones persistentes
+// ------------------------------------------------------
+
+// Crea un nodo que se queda con las referencias a izq y der que le pasan
+static Version nuevoNodoVersion(const shared_ptr<const DatosPersona>& datos,
+                                Version izq, Version der) {
+    NodoVersion* n = new NodoVersion();
+    n->datos = datos;
+    n->izq = izq;
+    n->der = der;
+    n->tamano = 1 + (izq ? izq->tamano : 0) + (der ? der->tamano : 0);
+    n->altura = 1 + max(izq ? izq->altura : 0, der ? der->altura : 0);
+    n->sumaEdades = datos->edad + (izq ? izq->sumaEdades : 0) + (der ? der->sumaEdades : 0);
+    n->referencias = 1;
+    return n;
+}
+
+Version retenerVersion(Version v) {
+    if (v) v->referencias++;
+    return v;
+}
+
+void soltarVersion(Version v) {
+    Pila<Version> pila;
+    if (v) pila.apilar(v);
+    while (!pila.vacia()) {
+        Version actual = pila.desapilar();
+        if (--actual->referencias > 0) continue;   // Otra versión lo sigue usando
+        if (actual->izq) pila.apilar(actual->izq);
+        if (actual->der) pila.apilar(actual->der);
+        delete actual;
+    }
+}
+
+Version versionDesdeArbol(Persona* raiz) {
+    // En pre-orden el hijo izquierdo va justo después del padre y el derecho
+    // después de todo el subárbol izquierdo: los tamaños dan las posiciones
+    vector<Persona*> orden;
+    recorrerPreOrden(VistaPersonas(raiz), [&orden](Persona* p) { orden.push_back(p); });
+
+    vector<Version> nodos(orden.size(), NULL);
+    for (size_t k = orden.size(); k-- > 0; ) {
+        Persona* p = orden[k];
+        Version izq = p->izq ? nodos[k + 1] : NULL;
+        Version der = p->der ? nodos[k + 1 + tamanoNodo(p->izq)] : NULL;
+        nodos[k] = nuevoNodoVersion(make_shared<DatosPersona>(datosDePersona(p)), izq, der);
+    }
+    return nodos.empty() ? NULL : nodos[0];
+}
+
+Persona* arbolDesdeVersion(Version v) {
+    if (v == NULL) return NULL;
+
+    // Cada nodo pendiente se apila junto con el hueco donde va su copia
+    struct Marco {
+        Version nodo;
+        Persona** hueco;
+    };
+    Persona* raiz = NULL;
+    Pila<Marco> pila;
+    Marco inicio = { v, &raiz };
+    pila.apilar(inicio);
+
+    while (!pila.vacia()) {
+        Marco m = pila.desapilar();
+        const DatosPersona& d = *m.nodo->datos;
+        Persona* p = crearPersona(d.id, d.nombre, d.apellido, d.edad,
+                                  d.fechaNacimiento, d.ocupacion, d.genero);
+        *m.hueco = p;
+        if (m.nodo->der) {
+            Marco der = { m.nodo->der, &p->der };
+            pila.apilar(der);
+        }
+        if (m.nodo->izq) {
+            Marco izq = { m.nodo->izq, &p->izq };
+            pila.apilar(izq);
+        }
+    }
+    recalcularAgregados(raiz);   // Padres y agregados
+    return raiz;
+}
+
+string rutaDePersona(Persona* p) {
+    string ruta;
+    for (; p != NULL && p->padre != NULL; p = p->padre)
+        ruta += (p->padre->izq == p) ? 'I' : 'D';
+    reverse(ruta.begin(), ruta.end());
+    return ruta;
+}
+
+bool rutaEnVersion(Version raiz, int id, string& ruta) {
+    // Pre-orden con la profundidad de cada nodo; la ruta se recorta al subir
+    struct Marco {
+        Version nodo;
+        size_t profundidad;
+        char lado;
+    };
+    Pila<Marco> pila;
+    if (raiz) {
+        Marco inicio = { raiz, 0, '\0' };
+        pila.apilar(inicio);
+    }
+    ruta.clear();
+    while (!pila.vacia()) {
+        Marco m = pila.desapilar();
+        ruta.resize(m.profundidad);
+        if (m.profundidad > 0) ruta[m.profundidad - 1] = m.lado;
+        if (m.nodo->datos->id == id) return true;
+
+        if (m.nodo->der) {
+            Marco der = { m.nodo->der, m.profundidad + 1, 'D' };
+            pila.apilar(der);
+        }
+        if (m.nodo->izq) {
+            Marco izq = { m.nodo->izq, m.profundidad + 1, 'I' };
+            pila.apilar(izq);
+        }
+    }
+    ruta.clear();
+    return false;
+}
+
+// Nodo al final de una ruta (NULL si la ruta se sale del árbol)
+static Version nodoEnRuta(Version raiz, const string& ruta) {
+    Version n = raiz;
+    for (size_t i = 0; i < ruta.size() && n != NULL; i++)
+        n = (ruta[i] == 'I') ? n->izq : n->der;
+    return n;
+}
+
+const NodoVersion* buscarEnVersion(Version raiz, int id) {
+    string ruta;
+    return rutaEnVersion(raiz, id, ruta) ? nodoEnRuta(raiz, ruta) : NULL;
+}
+
+// Copia los nodos de la ruta y pone 'reemplazo' (puede ser NULL) en el
+// lugar al que lleva. Se queda con la referencia de reemplazo y devuelve la
+// nueva raíz; todo lo que no está en la ruta se comparte con la anterior.
+static Version copiarCamino(Version raiz, const string& ruta, Version reemplazo) {
+    vector<Version> camino;
+    Version n = raiz;
+    for (size_t i = 0; i < ruta.size(); i++) {
+        camino.push_back(n);
+        n = (ruta[i] == 'I') ? n->izq : n->der;
+    }
+
+    Version actual = reemplazo;
+    for (size_t k = camino.size(); k-- > 0; ) {
+        Version viejo = camino[k];
+        Version izq = (ruta[k] == 'I') ? actual : retenerVersion(viejo->izq);
+        Version der = (ruta[k] == 'D') ? actual : retenerVersion(viejo->der);
+        actual = nuevoNodoVersion(viejo->datos, izq, der);
+    }
+    return actual;
+}
+
+Version insertarHijoEnRuta(Version raiz, const string& rutaPadre, const DatosPersona& datos,
+                           char lado, EstadoArbol* estado) {
+    EstadoArbol resultado;
+    Version padre = nodoEnRuta(raiz, rutaPadre);
+    if (padre == NULL) resultado = ESTADO_NO_EXISTE;
+    else if (lado == 'I' || lado == 'i' || lado == 'D' || lado == 'd') resultado = ESTADO_OK;
+    else resultado = ESTADO_LADO_INVALIDO;
+
+    if (resultado != ESTADO_OK) {
+        if (estado) *estado = resultado;
+        return retenerVersion(raiz);
+    }
+
+    bool izquierda = (lado == 'I' || lado == 'i');
+    if ((izquierda ? padre->izq : padre->der) != NULL) resultado = ESTADO_REEMPLAZADO;
+    if (estado) *estado = resultado;
+
+    Version hoja = nuevoNodoVersion(make_shared<DatosPersona>(datos), NULL, NULL);
+    return copiarCamino(raiz, rutaPadre + (izquierda ? 'I' : 'D'), hoja);
+}
+
+Version eliminarEnRuta(Version raiz, const string& ruta) {
+    if (nodoEnRuta(raiz, ruta) == NULL) return retenerVersion(raiz);
+    return copiarCamino(raiz, ruta, NULL);
+}
+
+Version insertarHijoPersistente(Version raiz, int idPadre, const DatosPersona& datos,
+                                char lado, EstadoArbol* estado) {
+    string rutaPadre, rutaNueva;
+    if (rutaEnVersion(raiz, datos.id, rutaNueva)) {
+        if (estado) *estado = ESTADO_ID_DUPLICADO;
+        return retenerVersion(raiz);
+    }
+    if (!rutaEnVersion(raiz, idPadre, rutaPadre)) {
+        if (estado) *estado = ESTADO_NO_EXISTE;
+        return retenerVersion(raiz);
+    }
+    return insertarHijoEnRuta(raiz, rutaPadre, datos, lado, estado);
+}
+
+Version insertarABBPersistente(Version raiz, const DatosPersona& datos, EstadoArbol* estado) {
+    // El orden por ID da la ruta en O(altura)
+    string ruta;
+    for (Version n = raiz; n != NULL; ) {
+        int id = n->datos->id;
+        if (datos.id == id) {
+            if (estado) *estado = ESTADO_ID_DUPLICADO;
+            return retenerVersion(raiz);
+        }
+        ruta += (datos.id < id) ? 'I' : 'D';
+        n = (datos.id < id) ? n->izq : n->der;
+    }
+    if (estado) *estado = ESTADO_OK;
+    return copiarCamino(raiz, ruta, nuevoNodoVersion(make_shared<DatosPersona>(datos), NULL, NULL));
+}
+
+Version eliminarPersonaPersistente(Version raiz, int id, EstadoArbol* estado) {
+    string ruta;
+    if (!rutaEnVersion(raiz, id, ruta)) {
+        if (estado) *estado = ESTADO_NO_EXISTE;
+        return retenerVersion(raiz);
+    }
+    if (estado) *estado = ESTADO_OK;
+    return copiarCamino(raiz, ruta, NULL);
+}
+
+int guardarVersion(HistorialVersiones& h, Version raiz, TipoArbol tipo, string descripcion) {
+    VersionGuardada v = { retenerVersion(raiz), tipo, descripcion };
+    h.versiones.push_back(v);
+    return (int)h.versiones.size() - 1;
+}
+
+void vaciarHistorial(HistorialVersiones& h) {
+    for (size_t i = 0; i < h.versiones.size(); i++) soltarVersion(h.versiones[i].raiz);
+    h.versiones.clear();
+}
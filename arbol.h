@@ -0,0 +1,1588 @@
+// ------------------------------------------------------
+// Biblioteca del árbol genealógico
+//
+// Operaciones del árbol sin interfaz: no leen de cin ni escriben en cout.
+// Las que pueden fallar devuelven un EstadoArbol (o bool en los archivos)
+// y el programa que las usa decide qué mostrar. El menú interactivo
+// (v4-final.cpp) es un cliente más de esta biblioteca.
+// ------------------------------------------------------
+#ifndef ARBOL_H
+#define ARBOL_H
+
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <vector>
+#include <new>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <random>
+#include <deque>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <chrono>
+#include <cstdio>
+
+// Estructura que representa cada persona en el árbol genealógico
+struct Persona {
+    int id;                       // Identificador único de la persona
+    std::string nombre;           // Nombre propio
+    std::string apellido;         // Apellido
+    int edad;                     // Edad de la persona
+    std::string fechaNacimiento;  // Fecha de nacimiento
+    std::string ocupacion;        // Ocupación o profesión
+    std::string genero;           // Género (Masculino/Femenino)
+    Persona* izq;                 // Hijo izquierdo
+    Persona* der;                 // Hijo derecho
+    Persona* padre;               // Padre (NULL en la raíz)
+
+    // Agregados del subárbol que cuelga de este nodo (incluido él mismo).
+    // Se mantienen al insertar/eliminar, así las estadísticas son O(1).
+    int altura;                   // Altura del subárbol
+    int tamano;                   // Cantidad de personas
+    long long sumaEdades;         // Suma de las edades
+    int generos[3];               // Personas por género (ver codigoGenero)
+};
+
+// Forma en que se construyó el árbol actual
+enum TipoArbol {
+    ARBOL_GENEALOGICO,        // Hijos enlazados manualmente (sin orden)
+    ARBOL_ABB,                // Árbol binario de búsqueda sin balancear
+    ARBOL_AVL                 // Árbol binario de búsqueda balanceado (AVL)
+};
+extern TipoArbol tipoArbol;
+
+// Resultado de las operaciones que modifican el árbol
+enum EstadoArbol {
+    ESTADO_OK,                // Operación realizada
+    ESTADO_REEMPLAZADO,       // Realizada, pero se liberó el subárbol que ocupaba ese lugar
+    ESTADO_NO_EXISTE,         // No hay una persona con ese ID
+    ESTADO_ID_DUPLICADO,      // El ID ya está en el árbol
+    ESTADO_LADO_INVALIDO      // El lado no es 'I' ni 'D'
+};
+
+// Texto que describe un estado (para mostrarlo o registrarlo)
+const char* mensajeEstado(EstadoArbol estado);
+
+// Índice hash ID -> Persona* que se mantiene sincronizado con el árbol.
+// Permite localizar a cualquier persona en tiempo constante sin recorrerlo.
+extern std::unordered_map<int, Persona*> indicePorID;
+
+// ---------------------
+// Utilidades
+// ---------------------
+
+// Pila en memoria dinámica para los recorridos sin recursión: su
+// profundidad solo está limitada por la memoria, no por la pila del proceso
+template <class T>
+struct Pila {
+    std::vector<T> elementos;
+
+    bool vacia() const      { return elementos.empty(); }
+    void apilar(const T& x) { elementos.push_back(x); }
+    T desapilar() {
+        T x = elementos.back();
+        elementos.pop_back();
+        return x;
+    }
+};
+
+// Reglas de validación compartidas por el ingreso manual y la importación
+bool edadValida(int edad);
+bool generoValido(const std::string& genero);
+
+// Código numérico del género: 0 = masculino, 1 = femenino, 2 = otro
+int codigoGenero(const std::string& genero);
+
+// ---------------------
+// Pool de memoria para nodos
+// ---------------------
+
+// Cantidad de personas que se reservan juntas en cada bloque contiguo
+const int PERSONAS_POR_BLOQUE = 4096;
+
+// Espacio para una persona dentro de un bloque del pool
+struct RanuraPersona {
+    alignas(Persona) unsigned char memoria[sizeof(Persona)];  // Debe ir primero
+    RanuraPersona* siguienteLibre;   // Enlace de la lista de ranuras libres
+    bool ocupada;                    // true si contiene una persona viva
+};
+
+// Bloque de ranuras contiguas del pool
+struct BloquePool {
+    RanuraPersona* ranuras;
+    int capacidad;                   // Ranuras del bloque
+    int usadas;                      // Ranuras ya entregadas alguna vez
+};
+
+// Pool de personas: reserva bloques grandes y recicla ranuras liberadas
+struct PoolPersonas {
+    std::vector<BloquePool> bloques;  // El último es el bloque "abierto"
+    RanuraPersona* libres;            // Ranuras devueltas, listas para reusar
+};
+
+extern PoolPersonas poolPersonas;
+
+// Obtiene memoria para una persona, reutilizando ranuras libres si las hay
+Persona* reservarPersona();
+
+// Reserva n personas en un único bloque contiguo (para construcciones masivas).
+// El bloque se ubica antes del bloque abierto para no desperdiciar su resto.
+RanuraPersona* reservarPersonasContiguas(int n);
+
+// Persona construida dentro de una ranura
+Persona* personaDeRanura(RanuraPersona* ranura);
+
+// Destruye una persona y devuelve su ranura a la lista libre
+void devolverPersona(Persona* p);
+
+// Libera de una vez todas las personas del pool: recorre los bloques en
+// orden de memoria (sin seguir punteros) y los devuelve al sistema
+void vaciarPool();
+
+// ---------------------
+// Funciones del Árbol
+// ---------------------
+
+// Carga los datos de una persona ya reservada y la registra en el índice
+void inicializarPersona(Persona* p, int id, std::string nombre, std::string apellido, int edad, 
+                        std::string fechaNac, std::string ocupacion, std::string genero);
+
+// Crea una nueva persona en el pool de memoria y la retorna
+Persona* crearPersona(int id, std::string nombre, std::string apellido, int edad, 
+                      std::string fechaNac, std::string ocupacion, std::string genero);
+
+// Libera una sola persona y la quita del índice de IDs
+void liberarPersona(Persona* p);
+
+// Elimina el árbol completo de una sola vez vaciando el pool y el índice.
+// Solo debe usarse cuando raiz es el único árbol vivo en el programa.
+void limpiarArbolCompleto(Persona*& raiz);
+
+// ---------------------
+// Agregados por subárbol
+// ---------------------
+
+// Altura de un nodo (0 si es nulo)
+int alturaNodo(Persona* p);
+
+// Recalcula los agregados de un nodo a partir de los de sus hijos
+void actualizarAgregados(Persona* p);
+
+// Actualiza los agregados desde un nodo hasta la raíz: O(profundidad)
+void propagarAgregados(Persona* desde);
+
+// Recalcula padres y agregados de todo el árbol (post-orden con pila).
+// Se usa cuando el árbol se armó enlazando nodos directamente.
+void recalcularAgregados(Persona* raiz);
+
+// Busca a una persona por su ID usando el índice hash (tiempo constante)
+Persona* buscar(Persona* raiz, int id);
+
+// Inserta un hijo izquierdo o derecho según la letra indicada. Si ese lado
+// estaba ocupado, el subárbol anterior se libera (ESTADO_REEMPLAZADO). Si
+// falla, nuevoHijo queda sin enlazar y lo libera quien lo creó.
+EstadoArbol insertarHijo(Persona* raiz, int idPadre, Persona* nuevoHijo, char lado);
+
+// Libera toda la memoria del árbol usando una pila explícita y devuelve
+// cuántas personas liberó
+int eliminarArbol(Persona* raiz);
+
+// Elimina una persona específica del árbol junto con todos sus descendientes.
+// La ubica con el índice de IDs y solo toca su subárbol y el camino hasta la
+// raíz. En liberadas (si no es NULL) deja cuántas personas salieron: 0 si
+// el ID no existe.
+Persona* eliminarPersona(Persona* raiz, int id, int* liberadas = NULL);
+
+// Ancestros de p, del padre hasta la raíz. Sube por los punteros al padre:
+// O(profundidad), sin recorrer otras ramas.
+std::vector<Persona*> ancestrosDe(Persona* p);
+
+// Generaciones de p hasta la raíz (0 en la raíz): O(profundidad)
+int profundidadDe(Persona* p);
+
+// ---------------------
+// Índices secundarios
+// ---------------------
+
+// Igual que indicePorID, se mantienen al crear y liberar personas, así que
+// insertarHijo, insertarABB, eliminarPersona y las cargas los dejan al día
+// sin hacer nada. No cuestan nada hasta la primera consulta (o hasta
+// activarIndicesSecundarios): recién ahí se arman en O(n). Cada consulta
+// cuesta lo que mide su resultado y no recorre el árbol.
+struct IndicesSecundarios {
+    bool activos;
+    std::unordered_map<std::string, std::unordered_set<Persona*> > porApellido;
+    std::unordered_map<std::string, std::unordered_set<Persona*> > porOcupacion;
+    std::map<int, std::unordered_set<Persona*> > porEdad;   // Ordenado para consultar rangos
+
+    // Mapa de bits por género sobre posiciones densas: al quitar a alguien,
+    // la última persona pasa a ocupar su posición
+    std::vector<Persona*> personas;                     // Posición -> persona
+    std::unordered_map<Persona*, uint32_t> posicion;
+    std::vector<uint64_t> bitsGenero[3];                // Ver codigoGenero
+};
+
+extern IndicesSecundarios indicesSecundarios;
+
+// Arma los índices con todas las personas vivas. Conviene llamarla antes de
+// consultar desde lectores concurrentes (la primera consulta los modifica).
+void activarIndicesSecundarios();
+
+// Avisos de crearPersona y liberarPersona (no hacen nada si no están activos)
+void indexarPersona(Persona* p);
+void desindexarPersona(Persona* p);
+
+// Consultas: devuelven las personas en cualquier orden
+std::vector<Persona*> buscarPorApellido(const std::string& apellido);
+std::vector<Persona*> buscarPorOcupacion(const std::string& ocupacion);
+std::vector<Persona*> buscarPorGenero(const std::string& genero);
+std::vector<Persona*> buscarPorEdad(int edadMinima, int edadMaxima);
+
+// ---------------------
+// Búsqueda por nombre (prefijos y parecidos)
+// ---------------------
+
+// Los nombres y apellidos se parten en palabras "plegadas": minúsculas, sin
+// acentos ni diéresis (á -> a, ñ -> n, ü -> u), venga el texto en UTF-8 o en
+// Windows-1252. Cada palabra distinta entra una sola vez en:
+//   - un trie comprimido (cada arista guarda un tramo de texto) para buscar
+//     por prefijo: "sof" lleva al subárbol de "sofia", "sofiana", ...
+//   - un índice de trigramas (" so", "sof", "ofi", ...) para tolerar errores
+//     de tipeo: dos palabras se parecen según cuántos trigramas comparten.
+// Las personas cuelgan de sus palabras, así que una consulta trabaja sobre
+// el vocabulario (miles de palabras) y no sobre las personas (millones).
+// Se mantiene igual que los índices secundarios y también se arma con la
+// primera consulta.
+
+// Nodo del trie comprimido (el 0 es la raíz)
+struct NodoTrie {
+    std::string tramo;                         // Texto de la arista que llega al nodo
+    int padre;
+    std::vector<std::pair<char, int> > hijos;  // Primer carácter del tramo -> nodo
+    int palabra;                               // Palabra que termina acá (-1 si ninguna)
+    int personas;                              // Personas en todo el subárbol
+};
+
+struct IndiceNombres {
+    bool activo;
+    std::vector<NodoTrie> trie;
+    std::unordered_map<std::string, int> idDePalabra;
+    std::vector<std::string> palabras;    // Id -> texto plegado
+    std::vector<int> nodoDePalabra;       // Id -> nodo del trie
+    std::vector<std::unordered_set<Persona*> > personasDePalabra;
+    std::vector<int> trigramasDePalabra;  // Id -> cantidad de trigramas
+    std::unordered_map<uint32_t, std::vector<int> > palabrasDeTrigrama;
+};
+
+extern IndiceNombres indiceNombres;
+
+// Persona encontrada y qué tan bien coincide (1 = igual)
+struct CoincidenciaNombre {
+    Persona* persona;
+    double puntaje;
+};
+
+// Texto en minúsculas, sin acentos y con los separadores como espacios
+std::string plegarTexto(const std::string& texto);
+
+// Arma el índice con todas las personas vivas (la primera consulta lo llama)
+void activarIndiceNombres();
+
+// Hasta k personas en las que cada palabra de la consulta es prefijo de
+// alguna de sus palabras ("sof gonz"). Primero las palabras más cortas,
+// así una coincidencia exacta sale antes que una extensión.
+std::vector<Persona*> buscarNombresPorPrefijo(const std::string& consulta, int k);
+
+// Hasta k personas con nombres parecidos a la consulta ("Rodrigez"), de
+// mayor a menor puntaje: el promedio, entre las palabras de la consulta,
+// del coeficiente de Dice de trigramas con la palabra más parecida de la persona.
+std::vector<CoincidenciaNombre> buscarNombresParecidos(const std::string& consulta, int k);
+
+// ---------------------
+// Parentesco (ancestro común más cercano)
+// ---------------------
+
+// Para responder "¿qué es A de B?" hace falta el ancestro común más cercano
+// y a cuántas generaciones está cada uno de él. La tabla guarda el árbol en
+// preorden con la profundidad de cada posición: entre dos personas, la
+// posición menos profunda del tramo que va de la primera (sin incluirla) a
+// la segunda es un hijo del ancestro común. Una tabla de mínimos por
+// potencias de dos (sparse table) responde ese mínimo en O(1).
+// Se arma en la primera consulta (O(n log n)) y los avisos de cambio del
+// árbol la invalidan: la consulta siguiente la vuelve a armar.
+// Armarla modifica estado compartido aunque la consulta solo lea el árbol,
+// así que está protegida por un cerrojo propio: las consultas de parentesco
+// se pueden hacer desde lectores concurrentes, pero se atienden de a una.
+// Con activarParentesco se arma antes de repartir el trabajo y así ningún
+// lector paga la construcción.
+
+struct TablaParentesco {
+    bool valida;
+    Persona* raiz;                               // Árbol para el que se armó
+    std::unordered_map<Persona*, int> posicion;  // Persona -> posición en preorden
+    std::vector<Persona*> orden;                 // Preorden
+    std::vector<int> padre;                      // Posición del padre (-1 en la raíz)
+    std::vector<int> profundidad;                // Generaciones desde la raíz
+    std::vector<std::vector<int> > minimo;       // minimo[j][i]: la menos profunda de [i, i + 2^j)
+};
+
+extern TablaParentesco tablaParentesco;
+
+// Cómo se relacionan dos personas
+struct Parentesco {
+    Persona* ancestroComun;   // NULL si alguna no está en el árbol
+    int generacionesA;        // De a hasta el ancestro común
+    int generacionesB;        // De b hasta el ancestro común
+    std::string etiqueta;     // Qué es a de b: "tío abuelo", "prima segunda", ...
+};
+
+// La consulta siguiente vuelve a armar la tabla
+void invalidarParentesco();
+
+// Arma la tabla para raiz si no está armada (O(n log n))
+void activarParentesco(Persona* raiz);
+
+// Ancestro común más cercano de a y b (NULL si alguna no está en el árbol)
+Persona* ancestroComun(Persona* raiz, Persona* a, Persona* b);
+
+// Ancestro común, generaciones de cada uno hasta él y qué es a de b. La
+// etiqueta usa el género de a (las dos formas juntas si es "Otro").
+Parentesco calcularParentesco(Persona* raiz, Persona* a, Persona* b);
+
+// ------------------------------------------------------
+// Interfaz común de almacenamiento
+//
+// Los recorridos y las estadísticas se escriben una sola vez como plantillas
+// sobre una "vista" del árbol que ofrece:
+//   Nodo (tipo), nulo(), raiz(), izq(n), der(n),
+//   id(n), edad(n), genero(n) (código), nombre(n), apellido(n)
+// Así funcionan igual sobre nodos enlazados por punteros o sobre el
+// almacenamiento por arreglos paralelos (ArbolSoA).
+// ------------------------------------------------------
+
+// Vista sobre el árbol clásico de nodos Persona enlazados por punteros
+struct VistaPersonas {
+    typedef Persona* Nodo;
+    Persona* r;
+
+    explicit VistaPersonas(Persona* raiz) : r(raiz) {}
+
+    Nodo nulo() const                   { return NULL; }
+    Nodo raiz() const                   { return r; }
+    Nodo izq(Nodo n) const              { return n->izq; }
+    Nodo der(Nodo n) const              { return n->der; }
+    int id(Nodo n) const                { return n->id; }
+    int edad(Nodo n) const              { return n->edad; }
+    int genero(Nodo n) const            { return codigoGenero(n->genero); }
+    const std::string& nombre(Nodo n) const  { return n->nombre; }
+    const std::string& apellido(Nodo n) const { return n->apellido; }
+};
+
+// ---------------------
+// Almacenamiento por arreglos paralelos (SoA)
+// ---------------------
+
+const uint32_t SOA_NINGUNO = 0xFFFFFFFFu;   // Índice de "sin nodo"
+
+// Árbol guardado como estructura de arreglos: los campos que se leen en
+// cada recorrido (id, edad, género, hijos) están juntos y contiguos, y los
+// textos viven aparte, así un recorrido no arrastra cadenas por la caché
+struct ArbolSoA {
+    typedef uint32_t Nodo;
+
+    // Datos calientes: un elemento por persona
+    std::vector<int32_t>  ids;
+    std::vector<int32_t>  edades;
+    std::vector<uint8_t>  generos;          // Ver codigoGenero
+    std::vector<uint32_t> hijosIzq;
+    std::vector<uint32_t> hijosDer;
+
+    // Datos fríos: solo se tocan al mostrar una persona
+    std::vector<std::string> nombres, apellidos, fechas, ocupaciones, textosGenero;
+
+    uint32_t r;                                // Índice de la raíz
+    std::unordered_map<int, uint32_t> indice;  // ID -> índice
+
+    ArbolSoA() : r(SOA_NINGUNO) {}
+
+    // Interfaz común
+    Nodo nulo() const                   { return SOA_NINGUNO; }
+    Nodo raiz() const                   { return r; }
+    Nodo izq(Nodo n) const              { return hijosIzq[n]; }
+    Nodo der(Nodo n) const              { return hijosDer[n]; }
+    int id(Nodo n) const                { return ids[n]; }
+    int edad(Nodo n) const              { return edades[n]; }
+    int genero(Nodo n) const            { return generos[n]; }
+    const std::string& nombre(Nodo n) const  { return nombres[n]; }
+    const std::string& apellido(Nodo n) const { return apellidos[n]; }
+};
+
+// Agrega una persona sin enlazar y devuelve su índice (o SOA_NINGUNO si el ID existe)
+uint32_t crearPersonaSoA(ArbolSoA& a, int id, std::string nombre, std::string apellido, int edad,
+                         std::string fechaNac, std::string ocupacion, std::string genero);
+
+// Busca el índice de una persona por ID
+uint32_t buscarSoA(const ArbolSoA& a, int id);
+
+// Enlaza un hijo ya creado bajo el padre indicado (lado 'I' o 'D')
+bool insertarHijoSoA(ArbolSoA& a, int idPadre, uint32_t hijo, char lado);
+
+// Copia un árbol de punteros a una estructura SoA (pre-orden con pila),
+// de modo que los nodos cercanos en el recorrido quedan cercanos en memoria
+void convertirASoA(Persona* raiz, ArbolSoA& a);
+
+// ---------------------
+// Recorridos genéricos
+// ---------------------
+
+// Los recorridos no imprimen: llaman a visitar(nodo) en el orden que
+// corresponde y quien los usa decide qué hacer con cada persona.
+
+// Recorrido en PRE-ORDEN: raíz -> izquierda -> derecha
+template <class Arbol, class Visitante>
+void recorrerPreOrden(const Arbol& a, Visitante visitar) {
+    typedef typename Arbol::Nodo Nodo;
+    if (a.raiz() == a.nulo()) return;
+
+    Pila<Nodo> pila;
+    pila.apilar(a.raiz());
+    while (!pila.vacia()) {
+        Nodo actual = pila.desapilar();
+
+        // Primero se visita la raíz
+        visitar(actual);
+
+        // El derecho se apila primero para que el izquierdo salga antes
+        if (a.der(actual) != a.nulo()) pila.apilar(a.der(actual));
+        if (a.izq(actual) != a.nulo()) pila.apilar(a.izq(actual));
+    }
+}
+
+// Recorrido IN-ORDEN: izquierda -> raíz -> derecha
+template <class Arbol, class Visitante>
+void recorrerInOrden(const Arbol& a, Visitante visitar) {
+    typedef typename Arbol::Nodo Nodo;
+    Pila<Nodo> pila;
+    Nodo actual = a.raiz();
+
+    while (actual != a.nulo() || !pila.vacia()) {
+        // Bajar todo lo posible por el subárbol izquierdo
+        while (actual != a.nulo()) {
+            pila.apilar(actual);
+            actual = a.izq(actual);
+        }
+
+        // Visitar la raíz
+        actual = pila.desapilar();
+        visitar(actual);
+
+        // Subárbol derecho
+        actual = a.der(actual);
+    }
+}
+
+// Recorrido POST-ORDEN: izquierda -> derecha -> raíz
+template <class Arbol, class Visitante>
+void recorrerPostOrden(const Arbol& a, Visitante visitar) {
+    typedef typename Arbol::Nodo Nodo;
+    Pila<Nodo> pila;
+    Nodo actual = a.raiz();
+    Nodo ultimo = a.nulo();   // Último nodo visitado
+
+    while (actual != a.nulo() || !pila.vacia()) {
+        // Bajar todo lo posible por el subárbol izquierdo
+        while (actual != a.nulo()) {
+            pila.apilar(actual);
+            actual = a.izq(actual);
+        }
+
+        Nodo cima = pila.elementos.back();
+
+        // Si tiene derecho sin visitar, recorrerlo antes que la raíz
+        if (a.der(cima) != a.nulo() && a.der(cima) != ultimo) {
+            actual = a.der(cima);
+            continue;
+        }
+
+        // Finalmente se visita la raíz
+        pila.desapilar();
+        visitar(cima);
+        ultimo = cima;
+    }
+}
+
+// Cuenta cuántos nodos existen en el árbol
+template <class Arbol>
+int contarNodos(const Arbol& a) {
+    typedef typename Arbol::Nodo Nodo;
+    if (a.raiz() == a.nulo()) return 0;
+
+    int total = 0;
+    Pila<Nodo> pila;
+    pila.apilar(a.raiz());
+    while (!pila.vacia()) {
+        Nodo actual = pila.desapilar();
+        total++;
+        if (a.izq(actual) != a.nulo()) pila.apilar(a.izq(actual));
+        if (a.der(actual) != a.nulo()) pila.apilar(a.der(actual));
+    }
+    return total;
+}
+
+// Calcula la altura del árbol (profundidad máxima)
+template <class Arbol>
+int calcularAltura(const Arbol& a) {
+    typedef typename Arbol::Nodo Nodo;
+    if (a.raiz() == a.nulo()) return 0;
+
+    // Cada nodo se apila junto con su profundidad
+    struct Marco {
+        Nodo nodo;
+        int profundidad;
+    };
+
+    int altura = 0;
+    Pila<Marco> pila;
+    Marco inicio = { a.raiz(), 1 };
+    pila.apilar(inicio);
+
+    while (!pila.vacia()) {
+        Marco m = pila.desapilar();
+        if (m.profundidad > altura) altura = m.profundidad;
+
+        if (a.izq(m.nodo) != a.nulo()) {
+            Marco izq = { a.izq(m.nodo), m.profundidad + 1 };
+            pila.apilar(izq);
+        }
+        if (a.der(m.nodo) != a.nulo()) {
+            Marco der = { a.der(m.nodo), m.profundidad + 1 };
+            pila.apilar(der);
+        }
+    }
+    return altura;
+}
+
+// Versiones sobre el árbol de punteros
+int contarNodos(Persona* raiz);
+int calcularAltura(Persona* raiz);
+
+// ------------------------------------------------------
+// Recorridos en paralelo con un pool de hilos que roba tareas
+//
+// Cada hilo del pool tiene su propia cola: saca tareas del final de la suya
+// y, cuando se queda sin trabajo, roba del principio de la cola de otro.
+// Los recorridos dividen el árbol en subárboles de al menos CORTE_PARALELO
+// personas (el tamaño sale de los agregados de cada nodo) y los reparten
+// como tareas; por debajo del corte se recorre con una pila, sin hilos.
+// ------------------------------------------------------
+
+// Tamaño mínimo de subárbol que vale la pena mandar a otro hilo
+const int CORTE_PARALELO = 1 << 14;
+
+// Tareas lanzadas juntas; esperarGrupo vuelve cuando terminaron todas
+struct GrupoTareas {
+    std::atomic<int> pendientes;
+    GrupoTareas() : pendientes(0) {}
+};
+
+// Hilos que trabajan en los recorridos (el que espera también ayuda).
+// Si es menor que 2 los recorridos en paralelo se hacen en un solo hilo.
+unsigned hilosDelPool();
+
+// Limita los hilos que trabajan en los recorridos (0: todos los del pool) y
+// devuelve el límite que quedó. Sirve para medir cómo escalan; conviene
+// cambiarlo cuando no hay recorridos en curso.
+unsigned limitarHilosDelPool(unsigned hilos);
+
+// Encola una tarea en el pool. Se ejecuta en cualquier hilo.
+void lanzarTarea(GrupoTareas& grupo, std::function<void()> tarea);
+
+// Espera las tareas del grupo ejecutando tareas pendientes mientras tanto
+// (así un hilo del pool puede esperar sin bloquear a los demás). Cuando no
+// queda nada para robar duerme hasta que el grupo termine, sin ocupar un núcleo.
+void esperarGrupo(GrupoTareas& grupo);
+
+// Tamaño del subárbol de un nodo (0 si es nulo)
+inline int tamanoNodo(Persona* p) { return p ? p->tamano : 0; }
+
+// Recorre un subárbol en un solo hilo (pre-orden). El Acumulador recibe cada
+// nodo con su profundidad en visitar(p, profundidad) y puede cortar el
+// recorrido devolviendo true en terminado(). Se baja por la izquierda sin
+// pasar por la pila: solo se apilan los hijos derechos.
+template <class Acumulador>
+void acumularSecuencial(Persona* raiz, int profundidad, Acumulador& acc) {
+    struct Marco {
+        Persona* nodo;
+        int profundidad;
+    };
+    Pila<Marco> pila;
+    Marco inicio = { raiz, profundidad };
+    pila.apilar(inicio);
+
+    while (!pila.vacia()) {
+        Marco m = pila.desapilar();
+        for (Persona* p = m.nodo; p != NULL; p = p->izq) {
+            if (acc.terminado()) return;
+            acc.visitar(p, m.profundidad);
+            if (p->der) {
+                Marco der = { p->der, m.profundidad + 1 };
+                pila.apilar(der);
+            }
+            m.profundidad++;
+        }
+    }
+}
+
+// Baja por el hijo más grande y lanza como tarea al más chico cuando supera
+// la mitad del corte. Así la profundidad de tareas anidadas es O(log n) aun
+// en árboles degenerados (un hijo lanzado tiene a lo sumo la mitad de nodos).
+template <class Acumulador>
+void acumularParalelo(Persona* p, int profundidad, Acumulador& acc, const Acumulador& inicial) {
+    GrupoTareas grupo;
+    std::deque<Acumulador> parciales;   // deque: las referencias no se invalidan
+
+    while (p != NULL && !acc.terminado()) {
+        if (p->tamano <= CORTE_PARALELO) {
+            acumularSecuencial(p, profundidad, acc);
+            break;
+        }
+        acc.visitar(p, profundidad);
+        profundidad++;
+
+        Persona* mayor = p->izq;
+        Persona* menor = p->der;
+        if (tamanoNodo(menor) > tamanoNodo(mayor)) std::swap(mayor, menor);
+
+        if (tamanoNodo(menor) >= CORTE_PARALELO / 2) {
+            parciales.push_back(inicial);
+            Acumulador* destino = &parciales.back();
+            const Acumulador* base = &inicial;
+            int prof = profundidad;
+            lanzarTarea(grupo, [menor, prof, destino, base]() {
+                acumularParalelo(menor, prof, *destino, *base);
+            });
+        } else if (menor != NULL) {
+            acumularSecuencial(menor, profundidad, acc);
+        }
+        p = mayor;
+    }
+
+    esperarGrupo(grupo);
+    for (size_t i = 0; i < parciales.size(); i++)
+        acc.unir(parciales[i]);
+}
+
+// Recorre todo el árbol en paralelo partiendo de una copia de inicial y
+// devuelve el acumulador con los resultados de todas las tareas unidos
+template <class Acumulador>
+Acumulador recorrerEnParalelo(Persona* raiz, const Acumulador& inicial) {
+    Acumulador acc = inicial;
+    if (raiz == NULL) return acc;
+    if (hilosDelPool() < 2 || raiz->tamano <= CORTE_PARALELO)
+        acumularSecuencial(raiz, 1, acc);
+    else
+        acumularParalelo(raiz, 1, acc, inicial);
+    return acc;
+}
+
+// Resumen de edades y géneros calculado recorriendo el árbol
+struct ResumenEdades {
+    long long total;
+    long long sumaEdades;
+    int edadMinima;
+    int edadMaxima;
+    long long generos[3];     // Por código de género (ver codigoGenero)
+};
+
+// Cuenta las personas recorriendo el árbol en paralelo
+long long contarEnParalelo(Persona* raiz);
+
+// Altura (profundidad máxima) recorriendo el árbol en paralelo
+int alturaEnParalelo(Persona* raiz);
+
+// Total, suma, mínimo y máximo de edades y conteo por género en paralelo
+ResumenEdades edadesEnParalelo(Persona* raiz);
+
+// Acumulador que se detiene en la primera persona que cumple el predicado.
+// Todas las tareas comparten el resultado, así las demás dejan de buscar.
+template <class Predicado>
+struct AcumuladorBusqueda {
+    Predicado cumple;
+    std::atomic<Persona*>* encontrada;
+
+    void visitar(Persona* p, int) {
+        Persona* nadie = NULL;
+        if (cumple(p)) encontrada->compare_exchange_strong(nadie, p);
+    }
+    void unir(const AcumuladorBusqueda&) {}
+    bool terminado() const { return encontrada->load(std::memory_order_relaxed) != NULL; }
+};
+
+// Busca en paralelo una persona que cumpla el predicado. Si hay varias,
+// devuelve la primera que encuentre cualquiera de los hilos (no
+// necesariamente la primera en pre-orden). NULL si no hay ninguna.
+template <class Predicado>
+Persona* buscarPrimeroEnParalelo(Persona* raiz, Predicado cumple) {
+    std::atomic<Persona*> encontrada(NULL);
+    AcumuladorBusqueda<Predicado> acc = { cumple, &encontrada };
+    recorrerEnParalelo(raiz, acc);
+    return encontrada.load();
+}
+
+// ---------------------
+// Árbol binario de búsqueda (ABB)
+// ---------------------
+
+// Inserta una persona en un Árbol Binario de Búsqueda (ABB) según su ID
+// (de forma iterativa para no desbordar la pila en árboles degenerados).
+// Si el ID ya existe, nueva se libera y estado (si se pasa) queda en
+// ESTADO_ID_DUPLICADO. Retorna la raíz del ABB.
+Persona* insertarABB(Persona* raiz, Persona* nueva, EstadoArbol* estado = NULL);
+
+// Busca por ID aprovechando el orden del ABB/AVL: O(altura) comparaciones
+Persona* buscarABB(Persona* raiz, int id);
+
+// ---------------------
+// ABB balanceado (AVL)
+// ---------------------
+
+// Diferencia de alturas entre el subárbol izquierdo y el derecho
+int factorBalance(Persona* p);
+
+// Rotación simple a la derecha: el hijo izquierdo sube
+Persona* rotarDerecha(Persona* y);
+
+// Rotación simple a la izquierda: el hijo derecho sube
+Persona* rotarIzquierda(Persona* x);
+
+// Restaura la propiedad AVL en un nodo cuyos hijos ya están balanceados
+Persona* balancear(Persona* p);
+
+// Inserta una persona en el AVL según su ID y rebalancea el camino
+// (con ID repetido se comporta como insertarABB)
+Persona* insertarAVL(Persona* raiz, Persona* nueva, EstadoArbol* estado = NULL);
+
+// Separa el nodo de menor ID de un subárbol AVL (sin liberarlo)
+Persona* extraerMinimoAVL(Persona* raiz, Persona*& minimo);
+
+// Elimina únicamente la persona indicada del AVL y rebalancea el camino.
+// Los nodos se re-enlazan (no se copian datos) para que el índice siga válido.
+Persona* eliminarAVL(Persona* raiz, int id);
+
+// ---------------------
+// Construcción masiva de un ABB balanceado
+// ---------------------
+
+// Datos de una persona antes de crear su nodo
+struct DatosPersona {
+    int id;
+    std::string nombre;
+    std::string apellido;
+    int edad;
+    std::string fechaNacimiento;
+    std::string ocupacion;
+    std::string genero;
+};
+
+// Copia los datos de un nodo
+DatosPersona datosDePersona(const Persona* p);
+
+// Ordena repartiendo el arreglo en tramos que se ordenan en hilos separados
+// y luego se mezclan de a pares (también en paralelo)
+template <class T, class Comparador>
+void ordenarEnParalelo(std::vector<T>& datos, Comparador comparar) {
+    size_t n = datos.size();
+    unsigned hilos = std::thread::hardware_concurrency();
+    if (hilos < 2 || n < (1u << 16)) {
+        std::sort(datos.begin(), datos.end(), comparar);
+        return;
+    }
+
+    // Límites de cada tramo
+    std::vector<size_t> limites;
+    for (unsigned t = 0; t <= hilos; t++)
+        limites.push_back(n * t / hilos);
+
+    std::vector<std::thread> trabajadores;
+    for (unsigned t = 0; t < hilos; t++)
+        trabajadores.push_back(std::thread([&datos, &limites, comparar, t]() {
+            std::sort(datos.begin() + limites[t], datos.begin() + limites[t + 1], comparar);
+        }));
+    for (size_t t = 0; t < trabajadores.size(); t++) trabajadores[t].join();
+
+    // Mezclar tramos vecinos hasta que quede uno solo
+    for (size_t paso = 1; paso < hilos; paso *= 2) {
+        trabajadores.clear();
+        for (size_t t = 0; t + paso < hilos; t += 2 * paso) {
+            size_t ini = limites[t], medio = limites[t + paso];
+            size_t fin = limites[std::min((size_t)hilos, t + 2 * paso)];
+            trabajadores.push_back(std::thread([&datos, comparar, ini, medio, fin]() {
+                std::inplace_merge(datos.begin() + ini, datos.begin() + medio,
+                              datos.begin() + fin, comparar);
+            }));
+        }
+        for (size_t t = 0; t < trabajadores.size(); t++) trabajadores[t].join();
+    }
+}
+
+// Enlaza nodos ya ordenados por ID como un ABB de altura mínima en O(n).
+// El nodo de cada rango es su punto medio; los rangos pendientes se guardan
+// en una pila en lugar de usar recursión.
+Persona* enlazarBalanceado(const std::vector<Persona*>& ordenados);
+
+// Construye un ABB de altura mínima a partir de datos (ordenados o no).
+// Se ordenan pares (ID, posición) en lugar de mover los datos con sus
+// cadenas. Todos los nodos se reservan juntos en un solo bloque del pool.
+// Ante IDs repetidos se conserva el primero; los que ya existen en el
+// índice se descartan. El resultado también cumple la propiedad AVL.
+Persona* construirABBBalanceado(const std::vector<DatosPersona>& datos);
+
+// Reorganiza los nodos existentes como un ABB de altura mínima por ID,
+// sin reservar ni copiar personas (solo se re-enlazan)
+Persona* rebalancearComoABB(Persona* raiz);
+
+// Genera un árbol genealógico ficticio para pruebas
+Persona* generarArbolFicticio();
+
+// ------------------------------------------------------
+// Generador sintético de árboles para pruebas de carga
+//
+// Con la misma semilla produce siempre el mismo árbol. Las personas se
+// emiten en orden (cada padre antes que sus hijos) a una función destino,
+// así se puede armar el árbol en memoria o escribirlo directo a un archivo
+// sin guardar todas las personas.
+// ------------------------------------------------------
+
+// Forma del árbol generado
+enum FormaArbol {
+    FORMA_COMPLETO,       // Árbol completo por niveles
+    FORMA_ALEATORIO,      // Cada persona cuelga de un hueco libre al azar
+    FORMA_CADENA_IZQ,     // Lista degenerada por la izquierda
+    FORMA_CADENA_DER,     // Lista degenerada por la derecha (ABB con IDs crecientes)
+    FORMA_GENEALOGIA      // Familia realista: edades, apellidos y generaciones coherentes
+};
+
+// Persona generada, lista para enlazar con su padre
+struct RegistroGenerado {
+    int id;
+    int idPadre;          // 0 en la raíz
+    char lado;            // 'I', 'D' o '\0' en la raíz
+    DatosPersona datos;
+};
+
+const int ANIO_ACTUAL = 2025;   // Referencia para calcular edades
+
+// Generador con reglas propias de reparto para que la misma semilla dé el
+// mismo resultado en cualquier compilador (las distribuciones de <random>
+// no están garantizadas entre bibliotecas)
+struct GeneradorSintetico {
+    std::mt19937 motor;
+
+    explicit GeneradorSintetico(unsigned semilla) : motor(semilla) {}
+
+    // Entero uniforme en [min, max]
+    int entre(int min, int max) {
+        return min + (int)(motor() % (uint32_t)(max - min + 1));
+    }
+
+    // Índice con peso 1/(k+1): reparto tipo Zipf sobre una tabla de n elementos
+    int indiceFrecuente(int n) {
+        double total = 0;
+        for (int k = 0; k < n; k++) total += 1.0 / (k + 1);
+        double x = (motor() / 4294967296.0) * total;
+        for (int k = 0; k < n; k++) {
+            x -= 1.0 / (k + 1);
+            if (x < 0) return k;
+        }
+        return n - 1;
+    }
+
+    // Completa nombre, ocupación, género y fecha según el año de nacimiento
+    // y la edad (la edad de los ancestros fallecidos es la que alcanzaron)
+    void completarDatos(DatosPersona& d, int anioNacimiento, int edad, int apellido);
+
+    // Datos para las formas sin restricciones familiares
+    void datosSimples(DatosPersona& d);
+
+    // Índice de un apellido de la tabla (los más comunes salen más seguido)
+    int apellidoFrecuente();
+};
+
+// Emite n personas con la forma pedida. Destino recibe cada RegistroGenerado;
+// los padres siempre se emiten antes que sus hijos.
+template <class Destino>
+void generarPersonas(int n, FormaArbol forma, unsigned semilla, Destino emitir) {
+    GeneradorSintetico gen(semilla);
+    RegistroGenerado r;
+
+    if (forma == FORMA_GENEALOGIA) {
+        // Cada persona pendiente de tener hijos (frente de la generación)
+        struct Familiar {
+            int id;
+            int nacimiento;
+            int fallecimiento;   // Año en que murió o el actual si vive
+            int apellido;
+            int hijos;           // 0, 1 o 2 hijos ya asignados
+        };
+
+        // Con ~1.9 hijos por persona hacen falta algo más de log2(n)
+        // generaciones; la raíz nace lo bastante atrás para que cada una
+        // (a lo sumo 35 años) quepa antes del año actual
+        int generaciones = 2;
+        for (long capacidad = 1; capacidad < n; capacidad *= 2) generaciones++;
+        generaciones += generaciones / 5;
+        int anioRaiz = ANIO_ACTUAL - 36 * generaciones;
+
+        std::deque<Familiar> frente;
+        int siguienteId = 1;
+        while (siguienteId <= n) {
+            int idPadre = 0, apellido, desde, hasta;
+            char lado = '\0';
+
+            if (siguienteId == 1) {
+                apellido = gen.apellidoFrecuente();
+                desde = hasta = anioRaiz;
+            } else {
+                if (frente.empty()) break;   // No quedan padres posibles
+                Familiar& padre = frente.front();
+
+                // Los hijos nacen entre los 18 y los 35 años del padre,
+                // mientras vive y nunca después del año actual
+                desde = padre.nacimiento + 18;
+                hasta = std::min(std::min(padre.nacimiento + 35, padre.fallecimiento), ANIO_ACTUAL);
+                if (desde > hasta) {
+                    frente.pop_front();
+                    continue;
+                }
+
+                idPadre = padre.id;
+                lado = (padre.hijos == 0) ? 'I' : 'D';
+                apellido = padre.apellido;   // El apellido se hereda
+                padre.hijos++;
+
+                // Algunas personas tienen un solo hijo
+                if (padre.hijos == 2 || gen.entre(0, 9) == 0) frente.pop_front();
+            }
+
+            // Vida de 40 a 95 años; si aún no llegó a ese año, vive
+            int nacimiento = gen.entre(desde, hasta);
+            int muerte = nacimiento + gen.entre(40, 95);
+            int edad = (muerte >= ANIO_ACTUAL) ? ANIO_ACTUAL - nacimiento : muerte - nacimiento;
+
+            r.id = siguienteId++;
+            r.idPadre = idPadre;
+            r.lado = lado;
+            r.datos.id = r.id;
+            gen.completarDatos(r.datos, nacimiento, edad, apellido);
+            emitir(r);
+
+            Familiar nuevo = { r.id, nacimiento, std::min(muerte, ANIO_ACTUAL), apellido, 0 };
+            frente.push_back(nuevo);
+        }
+        return;
+    }
+
+    // Huecos libres para la forma aleatoria (solo enteros, no personas)
+    std::vector< std::pair<int, char> > huecos;
+
+    for (int i = 1; i <= n; i++) {
+        r.id = i;
+        r.datos.id = i;
+        if (i == 1) {
+            r.idPadre = 0;
+            r.lado = '\0';
+        } else if (forma == FORMA_COMPLETO) {
+            // Numeración por niveles: el padre de i es i/2
+            r.idPadre = i / 2;
+            r.lado = (i % 2 == 0) ? 'I' : 'D';
+        } else if (forma == FORMA_CADENA_IZQ || forma == FORMA_CADENA_DER) {
+            r.idPadre = i - 1;
+            r.lado = (forma == FORMA_CADENA_IZQ) ? 'I' : 'D';
+        } else {
+            // Tomar un hueco al azar y reemplazarlo por el último
+            size_t k = gen.motor() % huecos.size();
+            r.idPadre = huecos[k].first;
+            r.lado = huecos[k].second;
+            huecos[k] = huecos.back();
+            huecos.pop_back();
+        }
+
+        if (forma == FORMA_ALEATORIO) {
+            huecos.push_back(std::make_pair(i, 'I'));
+            huecos.push_back(std::make_pair(i, 'D'));
+        }
+
+        gen.datosSimples(r.datos);
+        emitir(r);
+    }
+}
+
+// Arma en memoria un árbol sintético de n personas
+Persona* generarArbolSintetico(int n, FormaArbol forma, unsigned semilla);
+
+// Escribe un árbol sintético directamente como CSV (formato de importarCSV)
+// sin armarlo en memoria
+bool generarCSVSintetico(std::string nombreArchivo, int n, FormaArbol forma, unsigned semilla);
+
+// ---------------------
+// Archivo de texto
+// ---------------------
+
+// La salida se arma en un buffer de 1 MB y se escribe por bloques, sin
+// flush por línea. Para árboles enormes se puede seguir el avance:
+// 'nodos' escritos de 'total', con 'bytes' de texto generados
+typedef std::function<void(size_t nodos, size_t total, size_t bytes)> ProgresoExportacion;
+
+// Cada cuántos nodos se informa el avance
+const size_t NODOS_POR_AVISO = 1 << 16;
+
+// Guarda la estructura del árbol en un archivo de texto (pre-orden con pila)
+void guardarEnArchivo(Persona* raiz, std::ofstream& archivo);
+
+// Función que controla la escritura del árbol en archivo. Si el nombre
+// termina en ".gz" la salida se comprime con gzip (no disponible en Windows).
+// 'progreso' es opcional: se llama cada NODOS_POR_AVISO nodos y al final
+bool guardarArbolEnArchivo(Persona* raiz, std::string nombreArchivo,
+                           ProgresoExportacion progreso = ProgresoExportacion());
+
+// ------------------------------------------------------
+// Snapshot binario (.arb)
+//
+// Formato (enteros en little-endian, "var" = varint de 7 bits por byte):
+//   "ARBG"  u16 versión  u8 tipoArbol  u8 reservado  u32 nodos
+//   var cantidadCadenas, y por cada cadena: var largo + bytes
+//   Nodos en pre-orden, cada uno:
+//     u8 banderas (bit 0 = tiene izq, bit 1 = tiene der)
+//     var id (zigzag)  var edad
+//     var largo + nombre   var largo + fechaNacimiento
+//     var índice de apellido, ocupación y género en la tabla de cadenas
+// ------------------------------------------------------
+
+// Guarda el árbol en formato binario compacto
+bool guardarSnapshotBinario(Persona* raiz, std::string nombreArchivo);
+
+// Carga un snapshot binario leyendo el archivo una sola vez.
+// El árbol se reconstruye enlazando cada nodo en el hueco que le corresponde
+// según las banderas de su padre. Primero se valida el archivo completo: si
+// es inválido no se modifica nada. Si es válido reemplaza el árbol de raiz
+// (lo libera con limpiarArbolCompleto, así que debe ser el único árbol vivo).
+bool cargarSnapshotBinario(std::string nombreArchivo, Persona*& raiz);
+
+// ------------------------------------------------------
+// Registro de cambios (write-ahead log) y recuperación
+//
+// Cada cambio del árbol se agrega a base.wal en formato binario antes de
+// darse por hecho. Al arrancar, el árbol se reconstruye con el último
+// checkpoint (base.arb, un snapshot binario) más los cambios registrados
+// después. Un checkpoint guarda el árbol completo y empieza un registro
+// vacío, así el archivo no crece sin límite.
+//
+// Los registros se juntan en memoria y se escriben con un solo fsync por
+// lote: al juntar registrosPorLote registros o cuando pasaron msPorLote
+// desde el primero del lote. Un hilo temporizador vacía el lote al vencer
+// ese plazo aunque no lleguen más cambios, así un lote a medio llenar nunca
+// queda sin sincronizar más de msPorLote. Con registrosPorLote = 1 cada
+// cambio queda en disco al volver; con lotes más grandes un corte de luz
+// puede perder a lo sumo los últimos msPorLote de cambios.
+// ------------------------------------------------------
+
+// Tipo de cambio guardado en el registro
+enum OperacionRegistro {
+    REGISTRO_RAIZ = 1,        // Nueva raíz del árbol genealógico
+    REGISTRO_HIJO,            // insertarHijo
+    REGISTRO_ABB,             // insertarABB
+    REGISTRO_AVL,             // insertarAVL
+    REGISTRO_ELIMINAR,        // eliminarPersona (con sus descendientes)
+    REGISTRO_ELIMINAR_AVL,    // eliminarAVL (solo esa persona)
+    REGISTRO_LIMPIAR          // limpiarArbolCompleto
+};
+
+struct RegistroCambios {
+    std::string base;                                 // base.arb (checkpoint) y base.wal (registro)
+    FILE* archivo;                                    // base.wal abierto para agregar
+    std::string pendiente;                            // Registros que aún no se escribieron
+    int registrosPendientes;
+    long long registrosEnArchivo;                     // Desde el último checkpoint
+    std::chrono::steady_clock::time_point plazoLote;  // Vence el lote pendiente
+
+    // Temporizador del commit en grupo. El cerrojo protege pendiente y
+    // archivo, que usan a la vez el programa y el temporizador.
+    std::mutex cerrojo;
+    std::condition_variable hayPendientes;
+    std::thread temporizador;
+    bool cerrando;
+
+    // Política (se puede cambiar después de abrirRegistro)
+    int registrosPorLote;             // fsync cada tantos registros...
+    int msPorLote;                    // ...o cuando pasó este tiempo
+    long long registrosPorCheckpoint; // Checkpoint al superar esta cantidad
+};
+
+// Resultado de la recuperación al abrir el registro
+struct ResultadoRecuperacion {
+    bool habiaCheckpoint;             // Se cargó base.arb
+    long long aplicados;              // Cambios del registro aplicados
+    bool colaDescartada;              // El final del registro estaba incompleto o dañado
+    bool registroViejo;               // El registro era de un checkpoint anterior (ya incluido)
+};
+
+// Recupera el árbol (checkpoint + registro) en raiz, que debe estar vacía,
+// y deja el registro listo para agregar cambios. Un final incompleto (un
+// corte a mitad de escritura) se descarta y se recorta del archivo.
+bool abrirRegistro(RegistroCambios& reg, std::string base, Persona*& raiz, ResultadoRecuperacion& res);
+
+// Anota una persona agregada: REGISTRO_RAIZ, REGISTRO_HIJO (con idPadre y
+// lado), REGISTRO_ABB o REGISTRO_AVL
+void registrarAlta(RegistroCambios& reg, OperacionRegistro op, const Persona* p,
+                   int idPadre = 0, char lado = 0);
+
+// Anota una eliminación (REGISTRO_ELIMINAR, REGISTRO_ELIMINAR_AVL) o
+// REGISTRO_LIMPIAR (el ID no se usa)
+void registrarBaja(RegistroCambios& reg, OperacionRegistro op, int id);
+
+// Escribe los registros pendientes y espera a que lleguen al disco
+bool sincronizarRegistro(RegistroCambios& reg);
+
+// Guarda el árbol completo como checkpoint y vacía el registro. También se
+// usa después de cambios masivos (cargar, importar, generar, reorganizar).
+bool checkpointRegistro(RegistroCambios& reg, Persona* raiz);
+
+// Hace un checkpoint solo si el registro ya superó registrosPorCheckpoint
+bool checkpointSiCorresponde(RegistroCambios& reg, Persona* raiz);
+
+// Detiene el temporizador, sincroniza lo pendiente y cierra el archivo
+void cerrarRegistro(RegistroCambios& reg);
+
+// ------------------------------------------------------
+// Guardado incremental por segmentos (.ars)
+//
+// El árbol se parte en segmentos: subárboles de menos de
+// 2 * PERSONAS_POR_SEGMENTO personas que terminan donde empieza otro
+// segmento (ese hijo se guarda como referencia a su número de segmento).
+// insertarHijo, insertarABB y eliminarPersona marcan como sucio solo el
+// segmento del padre que tocaron, y el guardado siguiente agrega al final
+// del archivo esos segmentos y un directorio nuevo: cuesta O(cambiado) y no
+// O(n). Los cambios masivos (AVL, importar, generar, reorganizar, cargar,
+// limpiar) marcan todo el árbol y el guardado siguiente es completo.
+//
+// Formato (enteros en little-endian, "var" = varint como en el snapshot):
+//   Dos encabezados de 32 bytes que se usan en forma alternada:
+//     "ARBS"  u16 versión  u8 tipoArbol  u8 reservado  u64 secuencia
+//     u64 posición del directorio  u32 segmento raíz  u32 CRC de lo anterior
+//   Después segmentos y directorios, cada uno como u32 largo + u32 CRC + datos:
+//     segmento:   var número  var personas, y por persona en pre-orden
+//                 u8 hijos (2 bits por lado: 0 no hay, 1 sigue, 2 referencia)
+//                 var id (zigzag)  var edad  nombre apellido fecha ocupación
+//                 género (var largo + bytes)  var segmento de cada referencia
+//     directorio: var segmentos, y por número u64 posición + u32 largo
+//                 (largo 0 = número libre)
+//
+// Lo escrito no se pisa nunca: los datos nuevos van al final y recién
+// después se escribe el encabezado que los hace vigentes. Un corte a mitad
+// de guardado deja el estado anterior. Cuando el archivo supera el doble de
+// lo vigente, el guardado siguiente lo reescribe entero (temporal + rename).
+// ------------------------------------------------------
+
+// Un subárbol con al menos esta cantidad de personas pasa a ser su propio segmento
+const int PERSONAS_POR_SEGMENTO = 512;
+
+// Segmento del archivo, indexado por su número
+struct SegmentoGuardado {
+    Persona* raiz;               // NULL si el número está libre
+    uint64_t posicion;           // Dónde empieza su registro en el archivo
+    uint32_t largo;              // Bytes del registro (0 si está libre)
+    bool sucio;                  // Cambió desde el último guardado
+};
+
+// Seguimiento del último archivo .ars guardado o cargado
+struct GuardadoIncremental {
+    std::string nombreArchivo;                      // "" = sin seguimiento
+    Persona* raiz;                                  // Árbol al que corresponde
+    std::unordered_map<Persona*, uint32_t> segmentoDeRaiz;
+    std::vector<SegmentoGuardado> segmentos;
+    std::vector<uint32_t> libres;                   // Números para reutilizar
+    std::vector<uint32_t> sucios;                   // Pendientes de reescribir
+    bool todoSucio;                                 // El próximo guardado es completo
+    uint64_t secuencia;                             // Del encabezado vigente
+    uint64_t bytesArchivo;                          // Fin del último directorio
+    uint64_t bytesVigentes;                         // Encabezados + segmentos vivos
+};
+
+extern GuardadoIncremental guardadoIncremental;
+
+// Qué escribió un guardado incremental
+struct ResultadoGuardado {
+    bool completo;               // Se reescribió el archivo entero
+    int segmentos;               // Segmentos escritos
+    long long personas;          // Personas escritas
+    long long bytes;             // Bytes escritos
+};
+
+// Guarda el árbol en el archivo. Si es el mismo archivo y el mismo árbol
+// del guardado o la carga anterior, escribe solo los segmentos sucios.
+bool guardarIncremental(Persona* raiz, std::string nombreArchivo, ResultadoGuardado* resultado = NULL);
+
+// Carga un archivo .ars y empieza a seguir sus cambios. Igual que el
+// snapshot, valida todo antes de tocar el árbol: si falla no se modifica
+// nada y si no reemplaza el árbol de raiz (que debe ser el único vivo).
+bool cargarIncremental(std::string nombreArchivo, Persona*& raiz);
+
+// Avisos de las operaciones del árbol (no hacen nada sin seguimiento,
+// salvo invalidar la tabla de parentesco)
+void marcarSubarbolModificado(Persona* p);   // Cambiaron los hijos de p
+void marcarArbolModificado();                // Cambió la forma de todo el árbol
+void olvidarPersonaGuardada(Persona* p);     // p está por liberarse
+
+// ------------------------------------------------------
+// Imagen de solo lectura (.ari) para abrir con mmap
+//
+// El archivo es una copia plana de estas estructuras (little-endian):
+//   EncabezadoImagen | NodoImagen[nodos] | EntradaOrdenImagen[nodos] | cadenas
+// Los hijos y el padre son índices de 32 bits dentro del arreglo de nodos y
+// las cadenas son pares (desplazamiento, largo) dentro del bloque de cadenas.
+// Así las consultas leen directamente del archivo mapeado, sin reconstruir
+// el árbol ni reservar memoria.
+// ------------------------------------------------------
+
+const uint32_t IMAGEN_NINGUNO = 0xFFFFFFFFu;   // Índice de "sin nodo"
+
+// Encabezado con las estadísticas ya calculadas al guardar
+struct EncabezadoImagen {
+    char     magico[4];
+    uint16_t version;
+    uint8_t  tipoArbol;
+    uint8_t  reservado;
+    uint32_t nodos;            // Cantidad de personas
+    uint32_t altura;           // Altura del árbol
+    uint32_t generos[3];       // Masculino, femenino, otro
+    uint32_t offsetNodos;      // Desplazamientos desde el inicio del archivo
+    uint32_t offsetOrden;
+    uint32_t offsetCadenas;
+    uint32_t tamCadenas;
+    uint32_t reservado2;
+    uint64_t sumaEdades;
+};
+
+// Referencia a una cadena dentro del bloque de cadenas
+struct CadenaImagen {
+    uint32_t offset;
+    uint32_t largo;
+};
+
+// Persona dentro de la imagen (el nodo 0 es la raíz)
+struct NodoImagen {
+    int32_t  id;
+    int32_t  edad;
+    uint32_t izq, der, padre;  // Índices de nodo o IMAGEN_NINGUNO
+    CadenaImagen nombre, apellido, fechaNacimiento, ocupacion, genero;
+};
+
+// Entrada del índice ordenado por ID (búsqueda binaria)
+struct EntradaOrdenImagen {
+    int32_t  id;
+    uint32_t nodo;
+};
+
+static_assert(sizeof(EncabezadoImagen) == 56, "EncabezadoImagen no debe tener relleno");
+static_assert(sizeof(NodoImagen) == 60, "NodoImagen no debe tener relleno");
+
+// Imagen abierta: punteros directos a las secciones del archivo mapeado
+struct ImagenArbol {
+    const unsigned char*      base;
+    size_t                    tam;
+    const EncabezadoImagen*   enc;
+    const NodoImagen*         nodos;
+    const EntradaOrdenImagen* orden;
+    const char*               cadenas;
+};
+
+// Guarda el árbol como imagen plana lista para mapear en memoria
+bool guardarImagen(Persona* raiz, std::string nombreArchivo);
+
+// Libera el mapeo (o el buffer en Windows) de una imagen abierta
+void cerrarImagen(ImagenArbol& img);
+
+// Mapea el archivo en memoria y valida que sus secciones sean coherentes
+bool abrirImagen(std::string nombreArchivo, ImagenArbol& img);
+
+// Busca un ID con búsqueda binaria sobre el índice ordenado
+uint32_t buscarEnImagen(const ImagenArbol& img, int id);
+
+// Tipo de recorrido sobre la imagen
+enum OrdenRecorrido { RECORRIDO_PRE, RECORRIDO_IN, RECORRIDO_POST };
+
+// Recorre la imagen sin pila ni recursión usando los índices al padre:
+// se sabe de dónde se viene comparando con el nodo visitado anteriormente.
+// Llama a visitar(indice) con cada nodo en el orden pedido.
+template <class Visitante>
+void recorrerImagen(const ImagenArbol& img, OrdenRecorrido orden, Visitante visitar) {
+    if (img.enc->nodos == 0) return;
+
+    uint32_t actual = 0;                 // La raíz es el nodo 0
+    uint32_t previo = IMAGEN_NINGUNO;
+
+    while (actual != IMAGEN_NINGUNO) {
+        const NodoImagen& n = img.nodos[actual];
+        uint32_t siguiente;
+
+        if (previo == n.padre) {
+            // Se llega bajando desde el padre
+            if (orden == RECORRIDO_PRE) visitar(actual);
+            if (n.izq != IMAGEN_NINGUNO) {
+                siguiente = n.izq;
+            } else {
+                if (orden == RECORRIDO_IN) visitar(actual);
+                if (n.der != IMAGEN_NINGUNO) {
+                    siguiente = n.der;
+                } else {
+                    if (orden == RECORRIDO_POST) visitar(actual);
+                    siguiente = n.padre;
+                }
+            }
+        } else if (previo == n.izq) {
+            // Se vuelve del subárbol izquierdo
+            if (orden == RECORRIDO_IN) visitar(actual);
+            if (n.der != IMAGEN_NINGUNO) {
+                siguiente = n.der;
+            } else {
+                if (orden == RECORRIDO_POST) visitar(actual);
+                siguiente = n.padre;
+            }
+        } else {
+            // Se vuelve del subárbol derecho
+            if (orden == RECORRIDO_POST) visitar(actual);
+            siguiente = n.padre;
+        }
+
+        // Un índice fuera de rango indica un archivo dañado
+        if (siguiente != IMAGEN_NINGUNO && siguiente >= img.enc->nodos) return;
+
+        previo = actual;
+        actual = siguiente;
+    }
+}
+
+// ------------------------------------------------------
+// Importación masiva desde CSV/TSV
+//
+// Cada línea: id, idPadre, lado, nombre, apellido, edad, fecha, ocupacion, genero
+//   - La raíz lleva idPadre vacío o 0 y lado vacío.
+//   - lado es I (izquierdo) o D (derecho).
+//   - El separador es tabulación si la primera línea tiene alguna; si no, coma.
+//   - Los campos pueden ir entre comillas dobles (sin comillas internas).
+//   - Una primera línea cuyo id no es numérico se toma como encabezado.
+// ------------------------------------------------------
+
+// Resultado de una importación
+struct ResultadoImportacion {
+    long lineas;                       // Líneas de datos leídas
+    long importadas;                   // Personas agregadas al árbol
+    long rechazadas;                   // Líneas descartadas por algún error
+    std::vector<std::string> errores;  // Primeros errores, con número de línea
+};
+
+// Importa personas desde un archivo CSV/TSV. Si el árbol está vacío el
+// archivo debe traer una raíz; si no, todas las filas cuelgan del árbol actual.
+// Los hijos pueden aparecer antes que sus padres en el archivo.
+bool importarCSV(std::string nombreArchivo, Persona*& raiz, ResultadoImportacion& res);
+
+// ------------------------------------------------------
+// Acceso concurrente: muchos lectores y escritores
+//
+// El árbol, el índice de IDs y el pool son compartidos, así que toda la
+// estructura se protege con un único cerrojo de lectores/escritor. Las
+// consultas que solo leen (buscar, hijos, recorridos, estadísticas, incluso
+// los recorridos en paralelo) toman el cerrojo en modo lectura y pueden
+// ejecutarse a la vez; las modificaciones lo toman en modo exclusivo. Como
+// eliminarPersona solo corre con el cerrojo exclusivo, nunca libera un nodo
+// que un lector esté visitando.
+//
+// Algunas consultas arman su estructura la primera vez que se usan y esa
+// primera vez escriben. Antes de repartir el árbol entre lectores hay que
+// activarlas (con el cerrojo exclusivo o antes de crear los hilos):
+//   buscarPorApellido, buscarPorOcupacion, buscarPorGenero, buscarPorEdad
+//       -> activarIndicesSecundarios()
+//   buscarNombresPorPrefijo, buscarNombresParecidos -> activarIndiceNombres()
+// Una vez activos, los cambios del árbol los mantienen al día. La tabla de
+// parentesco se rearma después de cada cambio y tiene su propio cerrojo:
+// ancestroComun y calcularParentesco son seguras sin activar nada (con
+// activarParentesco ningún lector paga la construcción).
+//
+// Los punteros a Persona solo son válidos mientras se tiene el cerrojo: las
+// funciones de lectura entregan el nodo a una función y no lo devuelven.
+// ------------------------------------------------------
+
+// Cerrojo de lectores/escritor (C++11 no trae shared_mutex). Da prioridad a
+// los escritores: cuando uno espera, los lectores nuevos esperan detrás de él
+// para que un flujo constante de consultas no lo deje sin turno.
+struct CerrojoLectoresEscritor {
+    std::mutex cerrojo;
+    std::condition_variable puedeLeer;
+    std::condition_variable puedeEscribir;
+    int lectores;              // Lectores dentro
+    int escritoresEsperando;   // Escritores en cola
+    bool escribiendo;          // Hay un escritor dentro
+
+    CerrojoLectoresEscritor() : lectores(0), escritoresEsperando(0), escribiendo(false) {}
+};
+
+void bloquearLectura(CerrojoLectoresEscritor& c);
+void desbloquearLectura(CerrojoLectoresEscritor& c);
+void bloquearEscritura(CerrojoLectoresEscritor& c);
+void desbloquearEscritura(CerrojoLectoresEscritor& c);
+
+// Toma el cerrojo en modo lectura mientras exista (se libera al salir del bloque)
+struct BloqueoLectura {
+    CerrojoLectoresEscritor& c;
+    explicit BloqueoLectura(CerrojoLectoresEscritor& cerrojo) : c(cerrojo) { bloquearLectura(c); }
+    ~BloqueoLectura() { desbloquearLectura(c); }
+private:
+    BloqueoLectura(const BloqueoLectura&);
+    BloqueoLectura& operator=(const BloqueoLectura&);
+};
+
+// Toma el cerrojo en modo exclusivo mientras exista
+struct BloqueoEscritura {
+    CerrojoLectoresEscritor& c;
+    explicit BloqueoEscritura(CerrojoLectoresEscritor& cerrojo) : c(cerrojo) { bloquearEscritura(c); }
+    ~BloqueoEscritura() { desbloquearEscritura(c); }
+private:
+    BloqueoEscritura(const BloqueoEscritura&);
+    BloqueoEscritura& operator=(const BloqueoEscritura&);
+};
+
+// Árbol que se comparte entre hilos: la raíz junto con su cerrojo
+struct ArbolCompartido {
+    Persona* raiz;
+    CerrojoLectoresEscritor cerrojo;
+    ArbolCompartido() : raiz(NULL) {}
+};
+
+// Llama a usar(raiz) con el cerrojo de lectura tomado (recorridos, estadísticas)
+template <class Funcion>
+void leerArbol(ArbolCompartido& a, Funcion usar) {
+    BloqueoLectura bloqueo(a.cerrojo);
+    usar(a.raiz);
+}
+
+// Llama a usar(persona) con el cerrojo de lectura tomado. La persona y sus
+// hijos se pueden leer dentro de usar. Devuelve false si el ID no existe.
+template <class Funcion>
+bool leerPersona(ArbolCompartido& a, int id, Funcion usar) {
+    BloqueoLectura bloqueo(a.cerrojo);
+    Persona* p = buscar(a.raiz, id);
+    if (p == NULL) return false;
+    usar((const Persona*)p);
+    return true;
+}
+
+// Llama a cambiar(raiz) con el cerrojo exclusivo; cambiar puede reemplazar la raíz
+template <class Funcion>
+void modificarArbol(ArbolCompartido& a, Funcion cambiar) {
+    BloqueoEscritura bloqueo(a.cerrojo);
+    cambiar(a.raiz);
+}
+
+// Copia los datos de una persona (la copia sigue válida sin el cerrojo)
+bool copiarPersona(ArbolCompartido& a, int id, DatosPersona& datos);
+
+// Versiones con cerrojo de las operaciones que modifican el árbol. La persona
+// se crea dentro del cerrojo porque crearPersona también toca el índice y el pool.
+EstadoArbol crearRaizCompartida(ArbolCompartido& a, const DatosPersona& datos);
+EstadoArbol insertarHijoCompartido(ArbolCompartido& a, int idPadre,
+                                   const DatosPersona& datos, char lado);
+EstadoArbol insertarABBCompartido(ArbolCompartido& a, const DatosPersona& datos);
+EstadoArbol eliminarPersonaCompartida(ArbolCompartido& a, int id);
+
+// ------------------------------------------------------
+// Versiones persistentes (copia de caminos)
+//
+// Una versión es un árbol inmutable: insertar o eliminar no toca los nodos
+// existentes, sino que copia solo el camino desde la raíz hasta el cambio y
+// devuelve una raíz nueva que comparte todos los demás subárboles con la
+// anterior. Guardar una versión es O(1) y cada cambio cuesta O(profundidad)
+// de memoria. Los datos de cada persona también se comparten entre copias.
+//
+// Los nodos llevan un contador de referencias. Cada función que devuelve una
+// Version entrega una referencia nueva que se debe soltar con soltarVersion
+// (también cuando la operación falla: se devuelve la misma raíz retenida).
+// Las versiones no tienen padres ni índice de IDs, así que se pueden
+// compartir entre hilos sin cerrojo.
+// ------------------------------------------------------
+
+struct NodoVersion {
+    std::shared_ptr<const DatosPersona> datos;  // Compartidos entre versiones
+    const NodoVersion* izq;
+    const NodoVersion* der;
+    int tamano;                                 // Agregados del subárbol (inmutables)
+    int altura;
+    long long sumaEdades;
+    mutable std::atomic<int> referencias;
+};
+
+typedef const NodoVersion* Version;        // NULL es el árbol vacío
+
+// Suma una referencia y devuelve la misma versión
+Version retenerVersion(Version v);
+
+// Quita una referencia; los nodos que quedan sin referencias se liberan
+// (con una pila, así una cadena larga no desborda la pila de llamadas)
+void soltarVersion(Version v);
+
+// Copia el árbol de punteros a una versión nueva: O(n)
+Version versionDesdeArbol(Persona* raiz);
+
+// Reconstruye un árbol de punteros con los datos de una versión: O(n).
+// Las personas se registran en el índice, así que el árbol actual debe
+// haberse limpiado antes (es la forma de volver atrás a una versión).
+Persona* arbolDesdeVersion(Version v);
+
+// Camino desde la raíz hasta un nodo como letras 'I'/'D'
+std::string rutaDePersona(Persona* p);                       // O(profundidad) por los padres
+bool rutaEnVersion(Version raiz, int id, std::string& ruta); // O(n): las versiones no tienen índice
+
+// Busca por ID recorriendo la versión (NULL si no está)
+const NodoVersion* buscarEnVersion(Version raiz, int id);
+
+// Agrega un hijo bajo el nodo al que lleva rutaPadre. No revisa IDs
+// duplicados (para usar junto a un árbol de punteros que ya los revisó).
+Version insertarHijoEnRuta(Version raiz, const std::string& rutaPadre, const DatosPersona& datos,
+                           char lado, EstadoArbol* estado = NULL);
+
+// Quita el subárbol al que lleva la ruta
+Version eliminarEnRuta(Version raiz, const std::string& ruta);
+
+// Igual que insertarHijo / insertarABB / eliminarPersona, pero devuelven una
+// versión nueva y dejan intacta la anterior
+Version insertarHijoPersistente(Version raiz, int idPadre, const DatosPersona& datos,
+                                char lado, EstadoArbol* estado = NULL);
+Version insertarABBPersistente(Version raiz, const DatosPersona& datos,
+                               EstadoArbol* estado = NULL);
+Version eliminarPersonaPersistente(Version raiz, int id, EstadoArbol* estado = NULL);
+
+// Lista de versiones guardadas (instantáneas) para auditar o volver atrás
+struct VersionGuardada {
+    Version raiz;              // Con una referencia propia
+    TipoArbol tipo;            // Tipo de árbol al guardarla
+    std::string descripcion;
+};
+
+struct HistorialVersiones {
+    std::vector<VersionGuardada> versiones;
+};
+
+// Guarda una versión en el historial en O(1) y devuelve su número
+int guardarVersion(HistorialVersiones& h, Version raiz, TipoArbol tipo, std::string descripcion);
+
+// Suelta todas las versiones del historial
+void vaciarHistorial(HistorialVersiones& h);
+
+#endif
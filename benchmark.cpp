@@ -0,0 +1,804 @@
+// ------------------------------------------------------
+// Benchmark de recorridos: versiones recursivas vs. iterativas
+// y almacenamiento por punteros vs. arreglos paralelos (SoA).
+// Con --json mide todas las operaciones del árbol (ns/op,
+// asignaciones y pico de memoria) en formato JSON.
+//
+// Compilar:  g++ -O2 -std=c++11 -pthread benchmark.cpp arbol.cpp -o benchmark
+// Ejecutar:  ./benchmark
+//            ./benchmark --json [--max N] > resultados.json
+// ------------------------------------------------------
+#include "arbol.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#ifndef _WIN32
+    #include <sys/resource.h>   // getrusage
+#endif
+using namespace std;
+
+// ---------------------
+// Conteo de asignaciones: reemplaza el operator new global
+// ---------------------
+
+size_t asignacionesTotales = 0;   // Llamadas a new desde el inicio
+size_t bytesTotales = 0;          // Bytes pedidos desde el inicio
+
+void* operator new(size_t tam) {
+    asignacionesTotales++;
+    bytesTotales += tam;
+    void* p = malloc(tam > 0 ? tam : 1);
+    if (p == NULL) throw bad_alloc();
+    return p;
+}
+
+// Sin inline: GCC avisa de un free sobre memoria de new al ver ambos juntos
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { ::operator delete(p); }
+
+// ---------------------
+// Pico de memoria residente (RSS)
+// ---------------------
+
+// Pico de RSS en KB. En Linux se lee VmHWM, que puede reiniciarse entre
+// mediciones; en otros sistemas es el pico de todo el proceso.
+long picoRSSkB() {
+#if defined(__linux__)
+    ifstream estado("/proc/self/status");
+    string linea;
+    while (getline(estado, linea)) {
+        if (linea.compare(0, 6, "VmHWM:") == 0) return atol(linea.c_str() + 6);
+    }
+    return 0;
+#elif defined(_WIN32)
+    return 0;   // Sin getrusage: no se informa
+#else
+    rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+  #ifdef __APPLE__
+    return uso.ru_maxrss / 1024;   // macOS lo da en bytes
+  #else
+    return uso.ru_maxrss;
+  #endif
+#endif
+}
+
+// Lleva el pico de RSS al valor actual (solo Linux; en otros no hace nada)
+void reiniciarPicoRSS() {
+#if defined(__linux__)
+    ofstream limpiar("/proc/self/clear_refs");
+    if (limpiar.is_open()) limpiar << "5";
+#endif
+}
+
+// Título de cada sección (mismo formato que los encabezados del menú)
+void mostrarEncabezado(string titulo) {
+    cout << "\n+------------------------------------------------+\n";
+    cout << "¦ " << setw(46) << left << titulo << " ¦\n";
+    cout << "+------------------------------------------------+\n";
+}
+
+// ---------------------
+// Recorridos iterativos de la biblioteca, mostrando cada persona en una
+// línea como lo hace el menú
+// ---------------------
+
+template <class Arbol>
+void mostrarLinea(const Arbol& a, typename Arbol::Nodo n) {
+    cout << "  • " << a.nombre(n) << " " << a.apellido(n)
+         << " (ID:" << a.id(n) << ", " << a.edad(n) << " años)\n";
+}
+
+template <class Arbol>
+void preOrden(const Arbol& a) {
+    recorrerPreOrden(a, [&a](typename Arbol::Nodo n) { mostrarLinea(a, n); });
+}
+
+template <class Arbol>
+void inOrden(const Arbol& a) {
+    recorrerInOrden(a, [&a](typename Arbol::Nodo n) { mostrarLinea(a, n); });
+}
+
+template <class Arbol>
+void postOrden(const Arbol& a) {
+    recorrerPostOrden(a, [&a](typename Arbol::Nodo n) { mostrarLinea(a, n); });
+}
+
+void preOrden(Persona* raiz)  { preOrden(VistaPersonas(raiz)); }
+void inOrden(Persona* raiz)   { inOrden(VistaPersonas(raiz)); }
+void postOrden(Persona* raiz) { postOrden(VistaPersonas(raiz)); }
+
+// ---------------------
+// Versiones recursivas originales (solo para comparar)
+// ---------------------
+
+void preOrdenRecursivo(Persona* raiz) {
+    if (raiz == NULL) return;
+    cout << "  • " << raiz->nombre << " " << raiz->apellido
+         << " (ID:" << raiz->id << ", " << raiz->edad << " años)\n";
+    preOrdenRecursivo(raiz->izq);
+    preOrdenRecursivo(raiz->der);
+}
+
+void inOrdenRecursivo(Persona* raiz) {
+    if (raiz == NULL) return;
+    inOrdenRecursivo(raiz->izq);
+    cout << "  • " << raiz->nombre << " " << raiz->apellido
+         << " (ID:" << raiz->id << ", " << raiz->edad << " años)\n";
+    inOrdenRecursivo(raiz->der);
+}
+
+void postOrdenRecursivo(Persona* raiz) {
+    if (raiz == NULL) return;
+    postOrdenRecursivo(raiz->izq);
+    postOrdenRecursivo(raiz->der);
+    cout << "  • " << raiz->nombre << " " << raiz->apellido
+         << " (ID:" << raiz->id << ", " << raiz->edad << " años)\n";
+}
+
+int contarNodosRecursivo(Persona* raiz) {
+    if (raiz == NULL) return 0;
+    return 1 + contarNodosRecursivo(raiz->izq) + contarNodosRecursivo(raiz->der);
+}
+
+int calcularAlturaRecursivo(Persona* raiz) {
+    if (raiz == NULL) return 0;
+    int altIzq = calcularAlturaRecursivo(raiz->izq);
+    int altDer = calcularAlturaRecursivo(raiz->der);
+    return 1 + (altIzq > altDer ? altIzq : altDer);
+}
+
+// Exportación a texto como era antes: operador << con endl en cada línea
+// y la indentación de cuatro en cuatro espacios
+void guardarEnArchivoConEndl(Persona* raiz, ofstream& archivo) {
+    VistaPersonas vista(raiz);
+    recorrerPreOrden(vista, [&](Persona* p) {
+        int nivel = 0;
+        for (Persona* a = p->padre; a != NULL; a = a->padre) nivel++;
+        if (p->padre != NULL) {
+            for (int i = 0; i < nivel - 1; i++) archivo << "    ";
+            archivo << (p->padre->izq == p ? "¦  [Hijo Izquierdo]" : "¦  [Hijo Derecho]") << endl;
+        }
+        for (int i = 0; i < nivel; i++) archivo << "    ";
+        archivo << "+- ID: " << p->id << " | " << p->nombre << " " << p->apellido
+                << " | Edad: " << p->edad << " años | " << p->ocupacion << endl;
+    });
+}
+
+// ---------------------
+// Utilidades de medición
+// ---------------------
+
+// Buffer que descarta todo lo escrito (para no medir la terminal)
+struct BufferNulo : streambuf {
+    int overflow(int c) { return c; }
+};
+
+// Ejecuta la función con cout silenciado y devuelve los milisegundos
+template <class F>
+double medirMs(F funcion) {
+    BufferNulo nulo;
+    streambuf* original = cout.rdbuf(&nulo);
+
+    chrono::steady_clock::time_point inicio = chrono::steady_clock::now();
+    funcion();
+    chrono::steady_clock::time_point fin = chrono::steady_clock::now();
+
+    cout.rdbuf(original);
+    return chrono::duration<double, milli>(fin - inicio).count();
+}
+
+// Árbol balanceado de n personas (inserción AVL con IDs crecientes)
+Persona* construirBalanceado(int n) {
+    Persona* raiz = NULL;
+    for (int i = 1; i <= n; i++)
+        raiz = insertarAVL(raiz, crearPersona(i, "Nombre", "Apellido", i % 100,
+                                              "01/01/2000", "Oficio", "Masculino"));
+    return raiz;
+}
+
+// Árbol degenerado de n personas: el mismo que deja insertarABB con IDs
+// crecientes, pero enlazado directamente para no pagar O(n²) al construirlo
+Persona* construirDegenerado(int n) {
+    Persona* raiz = crearPersona(1, "Nombre", "Apellido", 1, "01/01/2000", "Oficio", "Masculino");
+    Persona* ultimo = raiz;
+    for (int i = 2; i <= n; i++) {
+        ultimo->der = crearPersona(i, "Nombre", "Apellido", i % 100,
+                                   "01/01/2000", "Oficio", "Masculino");
+        ultimo = ultimo->der;
+    }
+    recalcularAgregados(raiz);   // Padres y agregados de cada subárbol
+    return raiz;
+}
+
+// Imprime una fila de la tabla de resultados
+void mostrarFila(string operacion, double msRecursivo, bool recursivoSeguro, double msIterativo) {
+    cout << "  " << setw(16) << left << operacion;
+    if (recursivoSeguro)
+        cout << setw(14) << right << fixed << setprecision(2) << msRecursivo;
+    else
+        cout << setw(14) << right << "(desborda)";
+    cout << setw(14) << right << fixed << setprecision(2) << msIterativo << "\n";
+}
+
+// Compara todas las versiones sobre un árbol ya construido
+void compararRecorridos(string forma, Persona* raiz, int n, bool recursivoSeguro) {
+    cout << "\n" << forma << " - " << n << " personas\n";
+    cout << "  " << setw(16) << left << "Operación"
+         << setw(14) << right << "Recursivo ms" << setw(14) << right << "Iterativo ms" << "\n";
+
+    double r = 0;
+    if (recursivoSeguro) r = medirMs([&]() { preOrdenRecursivo(raiz); });
+    mostrarFila("preOrden", r, recursivoSeguro, medirMs([&]() { preOrden(raiz); }));
+
+    if (recursivoSeguro) r = medirMs([&]() { inOrdenRecursivo(raiz); });
+    mostrarFila("inOrden", r, recursivoSeguro, medirMs([&]() { inOrden(raiz); }));
+
+    if (recursivoSeguro) r = medirMs([&]() { postOrdenRecursivo(raiz); });
+    mostrarFila("postOrden", r, recursivoSeguro, medirMs([&]() { postOrden(raiz); }));
+
+    if (recursivoSeguro) r = medirMs([&]() { contarNodosRecursivo(raiz); });
+    mostrarFila("contarNodos", r, recursivoSeguro, medirMs([&]() { contarNodos(raiz); }));
+
+    if (recursivoSeguro) r = medirMs([&]() { calcularAlturaRecursivo(raiz); });
+    mostrarFila("calcularAltura", r, recursivoSeguro, medirMs([&]() { calcularAltura(raiz); }));
+}
+
+// Compara los mismos recorridos genéricos sobre punteros y sobre SoA
+void compararAlmacenamiento(string forma, Persona* raiz, int n) {
+    ArbolSoA soa;
+    convertirASoA(raiz, soa);
+    VistaPersonas punteros(raiz);
+
+    cout << "\n" << forma << " - " << n << " personas\n";
+    cout << "  " << setw(16) << left << "Operación"
+         << setw(14) << right << "Punteros ms" << setw(14) << right << "SoA ms" << "\n";
+
+    // Se mide antes de escribir: los recorridos también usan cout
+    double contarP  = medirMs([&]() { contarNodos(punteros); });
+    double contarS  = medirMs([&]() { contarNodos(soa); });
+    double alturaP  = medirMs([&]() { calcularAltura(punteros); });
+    double alturaS  = medirMs([&]() { calcularAltura(soa); });
+    double preP     = medirMs([&]() { preOrden(punteros); });
+    double preS     = medirMs([&]() { preOrden(soa); });
+
+    cout << fixed << setprecision(2);
+    cout << "  " << setw(16) << left << "contarNodos"
+         << setw(14) << right << contarP << setw(14) << right << contarS << "\n";
+    cout << "  " << setw(16) << left << "calcularAltura"
+         << setw(14) << right << alturaP << setw(14) << right << alturaS << "\n";
+    cout << "  " << setw(16) << left << "preOrden"
+         << setw(14) << right << preP << setw(14) << right << preS << "\n";
+}
+
+// Compara los recorridos de un solo hilo con los del pool de hilos
+void compararParalelo(string forma, Persona* raiz, int n) {
+    cout << "\n" << forma << " - " << n << " personas, " << hilosDelPool() << " hilos\n";
+    cout << "  " << setw(16) << left << "Operación"
+         << setw(14) << right << "1 hilo ms" << setw(14) << right << "Pool ms" << "\n";
+
+    // Resumen de edades y búsqueda del último ID (recorren todo el árbol)
+    long long suma = 0, generos[3] = { 0, 0, 0 };
+    int edadMinima = 1000, edadMaxima = -1;
+    Persona* hallada = NULL;
+    VistaPersonas vista(raiz);
+
+    double contar1  = medirMs([&]() { contarNodos(raiz); });
+    double contarP  = medirMs([&]() { contarEnParalelo(raiz); });
+    double altura1  = medirMs([&]() { calcularAltura(raiz); });
+    double alturaP  = medirMs([&]() { alturaEnParalelo(raiz); });
+    double edades1  = medirMs([&]() { recorrerPreOrden(vista, [&](Persona* p) {
+        suma += p->edad;
+        edadMinima = min(edadMinima, p->edad);
+        edadMaxima = max(edadMaxima, p->edad);
+        generos[codigoGenero(p->genero)]++;
+    }); });
+    double edadesP  = medirMs([&]() { edadesEnParalelo(raiz); });
+    double buscar1  = medirMs([&]() {
+        recorrerPreOrden(vista, [&](Persona* p) { if (!hallada && p->id == n) hallada = p; });
+    });
+    double buscarP  = medirMs([&]() {
+        buscarPrimeroEnParalelo(raiz, [n](Persona* p) { return p->id == n; });
+    });
+
+    cout << fixed << setprecision(2);
+    cout << "  " << setw(16) << left << "contar"  << setw(14) << right << contar1 << setw(14) << right << contarP << "\n";
+    cout << "  " << setw(16) << left << "altura"  << setw(14) << right << altura1 << setw(14) << right << alturaP << "\n";
+    cout << "  " << setw(16) << left << "edades"  << setw(14) << right << edades1 << setw(14) << right << edadesP << "\n";
+    cout << "  " << setw(16) << left << "buscarPrimero" << setw(14) << right << buscar1 << setw(14) << right << buscarP << "\n";
+
+    // Escalado: el mismo recorrido limitando el pool a 1, 2, 4, ... hilos.
+    // Cerca de lineal, la aceleración se acerca a la cantidad de hilos.
+    unsigned maximo = hilosDelPool();
+    cout << "  " << setw(16) << left << "Hilos"
+         << setw(14) << right << "contar ms" << setw(14) << right << "edades ms"
+         << setw(14) << right << "aceleración" << "\n";
+    double base = 0;
+    for (unsigned hilos = 1; ; hilos = (hilos * 2 > maximo) ? maximo : hilos * 2) {
+        limitarHilosDelPool(hilos);
+        double contar = medirMs([&]() { contarEnParalelo(raiz); });
+        double edades = medirMs([&]() { edadesEnParalelo(raiz); });
+        if (hilos == 1) base = contar + edades;
+        cout << "  " << setw(16) << left << hilos << setw(14) << right << contar
+             << setw(14) << right << edades << setw(13) << right << base / (contar + edades) << "x\n";
+        if (hilos == maximo) break;
+    }
+    limitarHilosDelPool(0);
+}
+
+// Tamaño de un archivo en bytes (0 si no existe)
+long long bytesDeArchivo(const char* nombre) {
+    ifstream archivo(nombre, ios::binary | ios::ate);
+    return archivo ? (long long)archivo.tellg() : 0;
+}
+
+// Compara la exportación a texto con endl por línea contra el escritor
+// con buffer, en ms y MB/s de texto generado
+void compararExportacion(string forma, Persona* raiz, int n) {
+    const char* temporal = "benchmark_tmp.txt";
+    const char* comprimido = "benchmark_tmp.txt.gz";
+
+    double msEndl = medirMs([&]() {
+        ofstream archivo(temporal);
+        guardarEnArchivoConEndl(raiz, archivo);
+    });
+    double msBuffer = medirMs([&]() { guardarArbolEnArchivo(raiz, temporal); });
+    double mb = bytesDeArchivo(temporal) / (1024.0 * 1024.0);
+    double msGzip = medirMs([&]() { guardarArbolEnArchivo(raiz, comprimido); });
+    double mbGzip = bytesDeArchivo(comprimido) / (1024.0 * 1024.0);
+    remove(temporal);
+    remove(comprimido);
+
+    cout << "\n" << forma << " - " << n << " personas, " << fixed << setprecision(1)
+         << mb << " MB de texto\n";
+    cout << "  " << setw(16) << left << "Escritor"
+         << setw(14) << right << "ms" << setw(14) << right << "MB/s" << "\n";
+    cout << setprecision(2);
+    cout << "  " << setw(16) << left << "endl por línea" << setw(14) << right << msEndl
+         << setw(14) << right << mb / (msEndl / 1000.0) << "\n";
+    cout << "  " << setw(16) << left << "buffer 1 MB" << setw(14) << right << msBuffer
+         << setw(14) << right << mb / (msBuffer / 1000.0) << "\n";
+    if (mbGzip > 0)
+        cout << "  " << setw(16) << left << "buffer + gzip" << setw(14) << right << msGzip
+             << setw(14) << right << mb / (msGzip / 1000.0) << "  (" << mbGzip << " MB en disco)\n";
+}
+
+// Compara reescribir todo el archivo (.arb y .ars completo) con guardar
+// de forma incremental después de agregar una sola persona
+void compararGuardadoIncremental(string forma, Persona* raiz, int n) {
+    const char* snapshot = "benchmark_tmp.arb";
+    const char* segmentos = "benchmark_tmp.ars";
+    ResultadoGuardado completo, incremental;
+
+    double msSnapshot = medirMs([&]() { guardarSnapshotBinario(raiz, snapshot); });
+    double msCompleto = medirMs([&]() { guardarIncremental(raiz, segmentos, &completo); });
+
+    // Una hoja nueva: solo se reescribe el segmento de su padre
+    Persona* hoja = raiz;
+    while (hoja->izq != NULL) hoja = hoja->izq;
+    insertarHijo(raiz, hoja->id, crearPersona(n + 1, "Nombre", "Apellido", 1, "01/01/2024",
+                                              "Oficio", "Femenino"), 'I');
+    double msIncremental = medirMs([&]() { guardarIncremental(raiz, segmentos, &incremental); });
+    double kbSnapshot = bytesDeArchivo(snapshot) / 1024.0;
+    remove(snapshot);
+    remove(segmentos);
+
+    cout << "\n" << forma << " - " << n << " personas\n";
+    cout << "  " << setw(22) << left << "Guardado"
+         << setw(14) << right << "ms" << setw(14) << right << "KB escritos" << "\n";
+    cout << fixed << setprecision(2);
+    cout << "  " << setw(22) << left << "snapshot .arb" << setw(14) << right << msSnapshot
+         << setw(14) << right << kbSnapshot << "\n";
+    cout << "  " << setw(22) << left << ".ars completo" << setw(14) << right << msCompleto
+         << setw(14) << right << completo.bytes / 1024.0 << "\n";
+    cout << "  " << setw(22) << left << ".ars tras 1 cambio" << setw(14) << right << msIncremental
+         << setw(14) << right << incremental.bytes / 1024.0 << "\n";
+}
+
+// Búsqueda por nombre: índice (trie y trigramas) contra recorrer el árbol
+// plegando cada nombre. Las consultas piden los primeros 10 resultados.
+void compararBusquedaNombres(string forma, Persona* raiz, int n) {
+    const int K = 10;
+    const int REPETICIONES = 200;
+    double msIndice = medirMs([]() { activarIndiceNombres(); });
+
+    cout << "\n" << forma << " - " << n << " personas (índice armado en "
+         << fixed << setprecision(2) << msIndice << " ms, "
+         << indiceNombres.palabras.size() << " palabras)\n";
+    cout << "  " << setw(24) << left << "Consulta"
+         << setw(14) << right << "índice µs" << setw(14) << right << "recorrido µs" << "\n";
+
+    // Comienzo de nombre: el recorrido se detiene al juntar K personas
+    const char* prefijos[] = { "Sof", "Rodrig", "mar go" };
+    for (int i = 0; i < 3; i++) {
+        string consulta = prefijos[i];
+        size_t cantidad = 0;
+        double msBusqueda = medirMs([&]() {
+            for (int r = 0; r < REPETICIONES; r++) cantidad = buscarNombresPorPrefijo(consulta, K).size();
+        });
+        string plegada = plegarTexto(consulta);
+        string primera = plegada.substr(0, plegada.find(' '));
+        double msRecorrido = medirMs([&]() {
+            size_t vistas = 0;
+            recorrerPreOrden(VistaPersonas(raiz), [&](Persona* p) {
+                if (vistas >= (size_t)K) return;
+                string nombre = " " + plegarTexto(p->nombre + " " + p->apellido);
+                if (nombre.find(" " + primera) != string::npos) vistas++;
+            });
+        });
+        cout << "  " << setw(24) << left << ("\"" + consulta + "\" (" + to_string(cantidad) + ")")
+             << setw(14) << right << msBusqueda * 1000 / REPETICIONES
+             << setw(14) << right << msRecorrido * 1000 << "\n";
+    }
+
+    // Parecidos: sin índice habría que puntuar a todas las personas; el
+    // recorrido solo pliega cada nombre, así que es una cota inferior
+    const char* aproximados[] = { "Rodrigez", "Gonzales", "Sofia Martines" };
+    for (int i = 0; i < 3; i++) {
+        string consulta = aproximados[i];
+        size_t cantidad = 0;
+        double msBusqueda = medirMs([&]() {
+            for (int r = 0; r < REPETICIONES; r++) cantidad = buscarNombresParecidos(consulta, K).size();
+        });
+        size_t letras = 0;
+        double msRecorrido = medirMs([&]() {
+            recorrerPreOrden(VistaPersonas(raiz), [&](Persona* p) {
+                letras += plegarTexto(p->nombre + " " + p->apellido).size();
+            });
+        });
+        if (letras == 0) cout << "  (árbol vacío)\n";
+        cout << "  " << setw(24) << left << ("~\"" + consulta + "\" (" + to_string(cantidad) + ")")
+             << setw(14) << right << msBusqueda * 1000 / REPETICIONES
+             << setw(14) << right << msRecorrido * 1000 << "\n";
+    }
+}
+
+// Ancestro común subiendo por los punteros al padre: O(profundidad)
+Persona* ancestroComunSubiendo(Persona* a, Persona* b) {
+    int pa = profundidadDe(a), pb = profundidadDe(b);
+    for (; pa > pb; pa--) a = a->padre;
+    for (; pb > pa; pb--) b = b->padre;
+    while (a != b) {
+        a = a->padre;
+        b = b->padre;
+    }
+    return a;
+}
+
+// Ancestro común: tabla de mínimos (armado + O(1) por consulta) contra
+// subir por los padres en cada consulta (que en una lista cuesta O(n))
+void compararParentesco(string forma, Persona* raiz, int n, int consultas) {
+    vector<Persona*> personas;
+    personas.reserve(n);
+    recorrerPreOrden(VistaPersonas(raiz), [&](Persona* p) { personas.push_back(p); });
+    mt19937 motor(7);
+    vector<pair<Persona*, Persona*> > pares(consultas);
+    for (int i = 0; i < consultas; i++)
+        pares[i] = make_pair(personas[motor() % personas.size()], personas[motor() % personas.size()]);
+
+    invalidarParentesco();
+    double msArmado = medirMs([&]() { ancestroComun(raiz, raiz, raiz); });
+    long long control = 0;
+    double msTabla = medirMs([&]() {
+        for (int i = 0; i < consultas; i++) control += ancestroComun(raiz, pares[i].first, pares[i].second)->id;
+    });
+    double msSubiendo = medirMs([&]() {
+        for (int i = 0; i < consultas; i++) control -= ancestroComunSubiendo(pares[i].first, pares[i].second)->id;
+    });
+
+    cout << "\n" << forma << " - " << n << " personas, altura " << raiz->altura << "\n";
+    cout << fixed << setprecision(3);
+    cout << "  Armado de la tabla: " << msArmado << " ms\n";
+    cout << "  " << setw(22) << left << "Por consulta" << setw(14) << right << "µs" << "\n";
+    cout << "  " << setw(22) << left << "tabla de mínimos" << setw(14) << right << msTabla * 1000 / consultas << "\n";
+    cout << "  " << setw(22) << left << "subiendo por padres" << setw(14) << right << msSubiendo * 1000 / consultas << "\n";
+    if (control != 0) cout << "  (los resultados no coinciden)\n";
+}
+
+// ---------------------
+// Suite completa en JSON (--json)
+// ---------------------
+
+// Resultado acumulado de una operación para una forma y un tamaño
+struct ResultadoOperacion {
+    string operacion;
+    string forma;
+    int n;
+    long long ops;          // Operaciones medidas (sumando repeticiones)
+    double ns;              // Tiempo total
+    size_t asignaciones;    // Llamadas a new durante la medición
+    size_t bytes;           // Bytes pedidos durante la medición
+    long picoKB;            // Pico de RSS del caso (forma y tamaño)
+};
+
+vector<ResultadoOperacion> resultados;
+
+// Mide una operación que realiza 'ops' pasos y acumula el resultado
+template <class F>
+void medirOperacion(string operacion, string forma, int n, long long ops, F funcion) {
+    size_t asigAntes = asignacionesTotales, bytesAntes = bytesTotales;
+    double ms = medirMs(funcion);
+    size_t asig = asignacionesTotales - asigAntes, bytes = bytesTotales - bytesAntes;
+
+    // Si ya se midió en una repetición anterior, se acumula
+    for (size_t i = 0; i < resultados.size(); i++) {
+        ResultadoOperacion& r = resultados[i];
+        if (r.operacion == operacion && r.forma == forma && r.n == n) {
+            r.ops += ops;
+            r.ns += ms * 1e6;
+            r.asignaciones += asig;
+            r.bytes += bytes;
+            return;
+        }
+    }
+    ResultadoOperacion r = { operacion, forma, n, ops, ms * 1e6, asig, bytes, 0 };
+    resultados.push_back(r);
+}
+
+// Nombre de cada forma en el JSON
+string nombreForma(FormaArbol forma) {
+    switch (forma) {
+        case FORMA_COMPLETO:   return "completo";
+        case FORMA_ALEATORIO:  return "aleatorio";
+        case FORMA_CADENA_IZQ: return "cadena_izq";
+        case FORMA_CADENA_DER: return "cadena_der";
+        default:               return "genealogia";
+    }
+}
+
+// Orden de inserción de IDs 1..n que hace que insertarABB produzca la forma
+// pedida (vacío si la forma no es un ABB, como la genealogía)
+vector<int> ordenParaABB(int n, FormaArbol forma, mt19937& motor) {
+    vector<int> orden;
+    if (forma == FORMA_GENEALOGIA) return orden;
+    orden.reserve(n);
+
+    if (forma == FORMA_COMPLETO) {
+        // Medianas por niveles: cada rango aporta su centro
+        deque< pair<int, int> > rangos;
+        rangos.push_back(make_pair(1, n));
+        while (!rangos.empty()) {
+            pair<int, int> r = rangos.front();
+            rangos.pop_front();
+            if (r.first > r.second) continue;
+            int medio = r.first + (r.second - r.first) / 2;
+            orden.push_back(medio);
+            rangos.push_back(make_pair(r.first, medio - 1));
+            rangos.push_back(make_pair(medio + 1, r.second));
+        }
+    } else {
+        for (int i = 1; i <= n; i++) orden.push_back(i);
+        if (forma == FORMA_CADENA_IZQ) reverse(orden.begin(), orden.end());
+        else if (forma == FORMA_ALEATORIO)
+            for (int i = n - 1; i > 0; i--) swap(orden[i], orden[motor() % (i + 1)]);
+    }
+    return orden;
+}
+
+// Mide todas las operaciones sobre un árbol de n personas con la forma dada.
+// Las operaciones O(profundidad) por nodo (y el archivo de texto, que se
+// indenta según el nivel) se omiten en cadenas muy largas porque serían O(n²).
+void medirCaso(FormaArbol forma, int n, int repeticiones) {
+    string f = nombreForma(forma);
+    bool cadena = (forma == FORMA_CADENA_IZQ || forma == FORMA_CADENA_DER);
+    bool cuadraticoViable = !cadena || n <= 10000;
+
+    // Forma del árbol (padre y lado de cada ID), calculada sin medir
+    vector<int> idPadre(n + 1, 0);
+    vector<char> lado(n + 1, '\0');
+    generarPersonas(n, forma, 1, [&](const RegistroGenerado& r) {
+        idPadre[r.id] = r.idPadre;
+        lado[r.id] = r.lado;
+    });
+
+    mt19937 motor(12345);
+    vector<int> consultas(n);
+    for (int i = 0; i < n; i++) consultas[i] = 1 + (int)(motor() % (uint32_t)n);
+    vector<int> ordenABB = ordenParaABB(n, forma, motor);
+
+    // El pico de memoria se toma por caso: leerlo en cada operación
+    // cuesta más que las operaciones chicas
+    size_t primerResultado = resultados.size();
+    reiniciarPicoRSS();
+
+    for (int rep = 0; rep < repeticiones; rep++) {
+        vector<Persona*> nodos(n);
+        Persona* raiz = NULL;
+
+        medirOperacion("crearPersona", f, n, n, [&]() {
+            for (int i = 0; i < n; i++)
+                nodos[i] = crearPersona(i + 1, "Nombre", "Apellido", i % 100,
+                                        "01/01/2000", "Oficio", (i % 2) ? "Femenino" : "Masculino");
+        });
+        raiz = nodos[0];
+
+        if (cuadraticoViable) {
+            medirOperacion("insertarHijo", f, n, n - 1, [&]() {
+                for (int i = 2; i <= n; i++) insertarHijo(raiz, idPadre[i], nodos[i - 1], lado[i]);
+            });
+        } else {
+            // Enlace directo y agregados en una pasada (sin medir)
+            for (int i = 2; i <= n; i++) {
+                Persona* padre = nodos[idPadre[i] - 1];
+                if (lado[i] == 'I') padre->izq = nodos[i - 1];
+                else padre->der = nodos[i - 1];
+            }
+            recalcularAgregados(raiz);
+        }
+
+        long long encontrados = 0;
+        medirOperacion("buscar", f, n, n, [&]() {
+            for (int i = 0; i < n; i++) encontrados += (buscar(raiz, consultas[i]) != NULL);
+        });
+        if (encontrados != n) cerr << "buscar: resultado inesperado\n";
+
+        medirOperacion("preOrden", f, n, n, [&]() { preOrden(raiz); });
+        medirOperacion("inOrden", f, n, n, [&]() { inOrden(raiz); });
+        medirOperacion("postOrden", f, n, n, [&]() { postOrden(raiz); });
+        medirOperacion("contarNodos", f, n, n, [&]() { contarNodos(raiz); });
+        medirOperacion("calcularAltura", f, n, n, [&]() { calcularAltura(raiz); });
+        medirOperacion("contarEnParalelo", f, n, n, [&]() { contarEnParalelo(raiz); });
+        medirOperacion("alturaEnParalelo", f, n, n, [&]() { alturaEnParalelo(raiz); });
+        medirOperacion("edadesEnParalelo", f, n, n, [&]() { edadesEnParalelo(raiz); });
+
+        if (cuadraticoViable) {
+            const char* temporal = "benchmark_tmp.txt";
+            medirOperacion("guardarArbolEnArchivo", f, n, n, [&]() { guardarArbolEnArchivo(raiz, temporal); });
+            remove(temporal);
+        }
+
+        // Cada padre tiene menor ID que sus hijos: quitar IDs de mayor a
+        // menor siempre elimina una hoja
+        int aEliminar = cuadraticoViable ? n / 10 : 0;
+        if (aEliminar > 0) {
+            medirOperacion("eliminarPersona", f, n, aEliminar, [&]() {
+                for (int i = n; i > n - aEliminar; i--) raiz = eliminarPersona(raiz, i);
+            });
+        }
+
+        int restantes = n - aEliminar;
+        medirOperacion("eliminarArbol", f, n, restantes, [&]() { eliminarArbol(raiz); });
+        raiz = NULL;
+
+        // ABB armado por insertarABB con el orden que da la misma forma
+        if (!ordenABB.empty() && cuadraticoViable) {
+            for (int i = 0; i < n; i++)
+                nodos[i] = crearPersona(ordenABB[i], "Nombre", "Apellido", i % 100,
+                                        "01/01/2000", "Oficio", "Masculino");
+            medirOperacion("insertarABB", f, n, n, [&]() {
+                for (int i = 0; i < n; i++) raiz = insertarABB(raiz, nodos[i]);
+            });
+        }
+
+        // Devolver toda la memoria antes del siguiente caso
+        limpiarArbolCompleto(raiz);
+    }
+
+    long pico = picoRSSkB();
+    for (size_t i = primerResultado; i < resultados.size(); i++) resultados[i].picoKB = pico;
+}
+
+// Escribe una cadena JSON (los nombres usados no llevan caracteres especiales)
+void escribirJSONTexto(const string& texto) {
+    cout << '"' << texto << '"';
+}
+
+// Recorre formas y tamaños (10 a maxN, por potencias de 10) y escribe el JSON
+void ejecutarSuiteJSON(int maxN) {
+    FormaArbol formas[] = { FORMA_COMPLETO, FORMA_ALEATORIO, FORMA_CADENA_IZQ,
+                            FORMA_CADENA_DER, FORMA_GENEALOGIA };
+
+    for (int forma = 0; forma < 5; forma++) {
+        for (long n = 10; n <= maxN; n *= 10) {
+            // Tamaños chicos se repiten para que el tiempo sea medible
+            int repeticiones = (n < 10000) ? (int)(10000 / n) : 1;
+            cerr << "  " << nombreForma(formas[forma]) << " n=" << n << "\n";
+            medirCaso(formas[forma], (int)n, repeticiones);
+        }
+    }
+
+    cout << "{\n  \"benchmark\": \"arbol-genealogico\",\n  \"resultados\": [\n";
+    for (size_t i = 0; i < resultados.size(); i++) {
+        const ResultadoOperacion& r = resultados[i];
+        double ops = (double)(r.ops > 0 ? r.ops : 1);
+        cout << "    {\"operacion\": ";
+        escribirJSONTexto(r.operacion);
+        cout << ", \"forma\": ";
+        escribirJSONTexto(r.forma);
+        cout << ", \"n\": " << r.n
+             << ", \"ops\": " << r.ops
+             << fixed << setprecision(2)
+             << ", \"ns_por_op\": " << r.ns / ops
+             << ", \"asignaciones\": " << r.asignaciones
+             << ", \"asignaciones_por_op\": " << r.asignaciones / ops
+             << ", \"bytes_por_op\": " << r.bytes / ops
+             << ", \"pico_rss_kb\": " << r.picoKB << "}"
+             << (i + 1 < resultados.size() ? "," : "") << "\n";
+    }
+    cout << "  ]\n}\n";
+}
+
+int main(int argc, char* argv[]) {
+    // Modo JSON: todas las operaciones, pensado para comparar ejecuciones
+    bool json = false;
+    int maxN = 1000000;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--json") json = true;
+        else if (arg == "--max" && i + 1 < argc) maxN = atoi(argv[++i]);
+    }
+    if (json) {
+        ejecutarSuiteJSON(maxN);
+        return 0;
+    }
+
+    mostrarEncabezado("BENCHMARK DE RECORRIDOS");
+
+    // Árboles balanceados: la recursión tiene profundidad O(log n)
+    int tamBalanceado[] = { 1000, 100000, 1000000 };
+    for (int i = 0; i < 3; i++) {
+        Persona* raiz = construirBalanceado(tamBalanceado[i]);
+        compararRecorridos("Balanceado (AVL)", raiz, tamBalanceado[i], true);
+        eliminarArbol(raiz);
+    }
+
+    // Árboles degenerados: la recursión desborda la pila a partir de ~100k
+    int tamDegenerado[] = { 1000, 10000, 100000, 1000000 };
+    for (int i = 0; i < 4; i++) {
+        Persona* raiz = construirDegenerado(tamDegenerado[i]);
+        compararRecorridos("Degenerado (lista)", raiz, tamDegenerado[i], tamDegenerado[i] <= 10000);
+        eliminarArbol(raiz);
+    }
+
+    // Mismo árbol con distinto almacenamiento
+    mostrarEncabezado("PUNTEROS VS. ARREGLOS PARALELOS (SoA)");
+    Persona* raiz = construirBalanceado(1000000);
+    compararAlmacenamiento("Balanceado (AVL)", raiz, 1000000);
+    eliminarArbol(raiz);
+
+    // Recorridos repartidos en el pool con robo de tareas
+    mostrarEncabezado("UN HILO VS. POOL DE HILOS");
+    raiz = generarArbolSintetico(1000000, FORMA_ALEATORIO, 1);
+    compararParalelo("Aleatorio", raiz, 1000000);
+    eliminarArbol(raiz);
+    raiz = construirBalanceado(1000000);
+    compararParalelo("Balanceado (AVL)", raiz, 1000000);
+    eliminarArbol(raiz);
+
+    // Exportación a texto: flush por línea contra buffer propio
+    mostrarEncabezado("EXPORTACIÓN A TEXTO (MB/s)");
+    raiz = generarArbolSintetico(1000000, FORMA_ALEATORIO, 1);
+    compararExportacion("Aleatorio", raiz, 1000000);
+    eliminarArbol(raiz);
+    raiz = construirDegenerado(5000);
+    compararExportacion("Degenerado (lista)", raiz, 5000);
+    eliminarArbol(raiz);
+
+    // Guardado completo contra incremental por segmentos
+    mostrarEncabezado("GUARDADO COMPLETO VS. INCREMENTAL");
+    raiz = generarArbolSintetico(1000000, FORMA_ALEATORIO, 1);
+    compararGuardadoIncremental("Aleatorio", raiz, 1000000);
+    eliminarArbol(raiz);
+
+    // Búsqueda por comienzo del nombre y por nombres parecidos
+    mostrarEncabezado("BÚSQUEDA POR NOMBRE");
+    raiz = generarArbolSintetico(1000000, FORMA_ALEATORIO, 1);
+    compararBusquedaNombres("Aleatorio", raiz, 1000000);
+    limpiarArbolCompleto(raiz);
+
+    // Parentesco: ancestro común más cercano
+    mostrarEncabezado("ANCESTRO COMÚN (PARENTESCO)");
+    raiz = generarArbolSintetico(1000000, FORMA_GENEALOGIA, 1);
+    compararParentesco("Genealogía", raiz, 1000000, 100000);
+    limpiarArbolCompleto(raiz);
+    raiz = construirDegenerado(100000);
+    compararParentesco("Degenerado (lista)", raiz, 100000, 1000);
+    eliminarArbol(raiz);
+
+    return 0;
+}
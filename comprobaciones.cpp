@@ -0,0 +1,195 @@
+// ------------------------------------------------------
+// Comprobaciones de la biblioteca: casos que ya fallaron alguna
+// vez y no deben volver. Cada una informa ok o FALLA y el
+// programa termina con código 1 si alguna falló.
+//
+// Compilar:  make comprobaciones   (o make check para compilar y ejecutar)
+// Ejecutar:  ./comprobaciones
+// ------------------------------------------------------
+#include "arbol.h"
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+#include <thread>
+#include <atomic>
+#include <random>
+using namespace std;
+
+int fallas = 0;   // Comprobaciones que no se cumplieron
+
+// Informa el resultado de una comprobación
+void comprobar(bool ok, string descripcion) {
+    cout << (ok ? "  ok     " : "  FALLA  ") << descripcion << "\n";
+    if (!ok) fallas++;
+}
+
+// ---------------------
+// Archivos
+// ---------------------
+
+// Escribe un archivo con el contenido exacto (sin agregar saltos)
+void escribirArchivo(const char* nombre, const string& contenido) {
+    FILE* f = fopen(nombre, "wb");
+    if (f == NULL) return;
+    fwrite(contenido.data(), 1, contenido.size(), f);
+    fclose(f);
+}
+
+// Un árbol vacío (después de limpiarlo o de borrar la raíz) tiene que poder
+// guardarse y volver a cargarse: es el checkpoint que deja el registro
+void comprobarGuardadoVacio() {
+    const char* snapshot = "comprobaciones_vacio.arb";
+    const char* segmentos = "comprobaciones_vacio.ars";
+    Persona* cargado = NULL;
+    comprobar(guardarSnapshotBinario(NULL, snapshot) && cargarSnapshotBinario(snapshot, cargado) &&
+              cargado == NULL, "árbol vacío: guardar y cargar .arb");
+    comprobar(guardarIncremental(NULL, segmentos) && cargarIncremental(segmentos, cargado) &&
+              cargado == NULL, "árbol vacío: guardar y cargar .ars");
+    remove(snapshot);
+    remove(segmentos);
+}
+
+// Una carga fallida (archivo inexistente o truncado) no toca el árbol
+// actual, y una válida lo reemplaza aunque repita sus IDs
+void comprobarCargaFallida() {
+    const char* formatos[] = { ".arb", ".ars" };
+    for (int i = 0; i < 2; i++) {
+        string nombre = string("comprobaciones_carga") + formatos[i];
+        string truncado = string("comprobaciones_truncado") + formatos[i];
+        bool ars = i == 1;
+
+        Persona* raiz = generarArbolSintetico(1000, FORMA_ALEATORIO, 7);
+        bool guardado = ars ? guardarIncremental(raiz, nombre) : guardarSnapshotBinario(raiz, nombre);
+
+        // Copia del archivo sin su último cuarto
+        ifstream entrada(nombre.c_str(), ios::binary);
+        string datos((istreambuf_iterator<char>(entrada)), istreambuf_iterator<char>());
+        escribirArchivo(truncado.c_str(), datos.substr(0, datos.size() * 3 / 4));
+
+        string archivos[] = { string("comprobaciones_no_existe") + formatos[i], truncado };
+        for (int a = 0; a < 2; a++) {
+            Persona* antes = raiz;
+            bool ok = ars ? cargarIncremental(archivos[a], raiz) : cargarSnapshotBinario(archivos[a], raiz);
+            comprobar(guardado && !ok && raiz == antes && contarNodos(raiz) == 1000 &&
+                      buscar(raiz, raiz->id) == raiz,
+                      string("cargar un ") + formatos[i] +
+                      (a == 0 ? " inexistente" : " truncado") + " deja el árbol como estaba");
+        }
+
+        // El archivo válido trae los mismos IDs que el árbol actual
+        bool ok = ars ? cargarIncremental(nombre, raiz) : cargarSnapshotBinario(nombre, raiz);
+        comprobar(ok && contarNodos(raiz) == 1000 && raiz->tamano == 1000,
+                  string("cargar un ") + formatos[i] + " válido reemplaza el árbol");
+
+        limpiarArbolCompleto(raiz);
+        remove(nombre.c_str());
+        remove(truncado.c_str());
+    }
+}
+
+// Un CSV con solo el encabezado no importa nada ni lee fuera del buffer
+// (con el encabezado sin salto final se leía más allá del último byte)
+void comprobarCSVSoloEncabezado() {
+    const char* nombre = "comprobaciones_encabezado.csv";
+    const string encabezado = "id,idPadre,lado,nombre,apellido,edad,fecha,ocupacion,genero";
+    const char* finales[] = { "", "\n", "\r", "\r\n" };
+    const char* descripciones[] = { "sin salto", "con LF", "con CR", "con CRLF" };
+
+    for (int i = 0; i < 4; i++) {
+        escribirArchivo(nombre, encabezado + finales[i]);
+        Persona* raiz = NULL;
+        ResultadoImportacion res;
+        bool ok = importarCSV(nombre, raiz, res);
+        comprobar(ok && raiz == NULL && res.lineas == 0 && res.rechazadas == 0,
+                  string("CSV con solo el encabezado ") + descripciones[i]);
+        limpiarArbolCompleto(raiz);
+    }
+    remove(nombre);
+}
+
+// ---------------------
+// Acceso concurrente
+// ---------------------
+
+// Varios lectores consultan (por ID, parentesco, apellido, prefijo del
+// nombre y conteo en paralelo) mientras un escritor agrega y elimina
+// personas. Pensada para correr con ThreadSanitizer; sin él comprueba que
+// al terminar el árbol y los índices sigan coherentes.
+void comprobarLectoresYEscritor() {
+    const int PERSONAS = 20000, LECTORES = 4, CAMBIOS = 200;
+    ArbolCompartido a;
+    a.raiz = generarArbolSintetico(PERSONAS, FORMA_GENEALOGIA, 11);
+
+    // Las estructuras que arma la primera consulta se arman antes
+    activarIndicesSecundarios();
+    activarIndiceNombres();
+    activarParentesco(a.raiz);
+
+    atomic<bool> terminado(false);
+    atomic<long long> consultas(0);
+    vector<thread> hilos;
+    for (int h = 0; h < LECTORES; h++) {
+        hilos.push_back(thread([&a, &terminado, &consultas, h]() {
+            mt19937 azar(h + 1);
+            while (!terminado) {
+                int id = (int)(azar() % PERSONAS) + 1, otro = (int)(azar() % PERSONAS) + 1;
+                leerPersona(a, id, [](const Persona* p) {
+                    volatile int edad = p->edad + (p->izq ? p->izq->edad : 0);
+                    (void)edad;
+                });
+                leerArbol(a, [&](Persona* raiz) {
+                    Persona* pa = buscar(raiz, id);
+                    Persona* pb = buscar(raiz, otro);
+                    if (pa && pb) calcularParentesco(raiz, pa, pb);
+                    buscarPorApellido("González");
+                    buscarNombresPorPrefijo("mar", 5);
+                    if (h == 0) contarEnParalelo(raiz);
+                });
+                consultas++;
+            }
+        }));
+    }
+
+    // Escritor: cada persona nueva cuelga de una al azar (puede reemplazar
+    // un subárbol) y de vez en cuando se elimina alguien
+    mt19937 azar(99);
+    int agregadas = 0;
+    for (int i = 0; i < CAMBIOS; i++) {
+        DatosPersona d = { PERSONAS + 1 + i, "Marina", "González", 30, "01/01/1995", "Docente", "Femenino" };
+        EstadoArbol e = insertarHijoCompartido(a, (int)(azar() % PERSONAS) + 1, d, (i % 2) ? 'I' : 'D');
+        if (e == ESTADO_OK || e == ESTADO_REEMPLAZADO) agregadas++;
+        if (i % 10 == 9) eliminarPersonaCompartida(a, (int)(azar() % PERSONAS) + 2);
+    }
+    terminado = true;
+    for (size_t i = 0; i < hilos.size(); i++) hilos[i].join();
+
+    // El árbol, sus agregados y los índices siguen de acuerdo
+    long long gonzalez = 0;
+    int contadas = 0;
+    recorrerPreOrden(VistaPersonas(a.raiz), [&](Persona* p) {
+        contadas++;
+        if (p->apellido == "González") gonzalez++;
+    });
+    comprobar(agregadas > 0 && consultas > 0 && a.raiz != NULL && contadas == a.raiz->tamano &&
+              (long long)buscarPorApellido("González").size() == gonzalez &&
+              contarEnParalelo(a.raiz) == contadas,
+              "lectores concurrentes con un escritor (" + to_string(LECTORES) + " lectores, " +
+              to_string(CAMBIOS) + " cambios)");
+    limpiarArbolCompleto(a.raiz);
+}
+
+int main() {
+    cout << "Comprobaciones de la biblioteca\n";
+    comprobarGuardadoVacio();
+    comprobarCSVSoloEncabezado();
+    comprobarCargaFallida();
+    comprobarLectoresYEscritor();
+
+    if (fallas > 0) {
+        cout << fallas << " comprobaciones fallaron\n";
+        return 1;
+    }
+    cout << "Todas las comprobaciones pasaron\n";
+    return 0;
+}
@@ -1,23 +1,11 @@
+#include "arbol.h"
 #include <iostream>
-#include <string>
 #include <limits>
-#include <fstream>
 #include <iomanip>
+#include <climits>
+#include <cstdio>
 using namespace std;
 
-// Estructura que representa cada persona en el rbol genealgico
-struct Persona {
-    int id;                   // Identificador nico de la persona
-    string nombre;            // Nombre propio
-    string apellido;          // Apellido
-    int edad;                 // Edad de la persona
-    string fechaNacimiento;   // Fecha de nacimiento
-    string ocupacion;         // Ocupacin o profesin
-    string genero;            // Gnero (Masculino/Femenino)
-    Persona* izq;             // Hijo izquierdo
-    Persona* der;             // Hijo derecho
-};
-
 // ---------------------
 // Utilidades
 // ---------------------
@@ -28,7 +16,7 @@ void limpiarEntrada() {
     cin.ignore(numeric_limits<streamsize>::max(), '\n');
 }
 
-// Pausa la ejecucin hasta que el usuario presione ENTER
+// Pausa la ejecución hasta que el usuario presione ENTER
 void pausar() {
     cout << "\n[Presiona ENTER para continuar]";
     cin.ignore(numeric_limits<streamsize>::max(), '\n');
@@ -46,89 +34,68 @@ void limpiarPantalla() {
 // Imprime un encabezado con un formato decorativo
 void mostrarEncabezado(string titulo) {
     cout << "\n+------------------------------------------------+\n";
-    cout << " " << setw(46) << left << titulo << " \n";
+    cout << "¦ " << setw(46) << left << titulo << " ¦\n";
     cout << "+------------------------------------------------+\n";
 }
 
 // ---------------------
-// Funciones del rbol
+// Registro de cambios (--registro)
 // ---------------------
 
-// Crea una nueva persona en memoria dinmica y la retorna
-Persona* crearPersona(int id, string nombre, string apellido, int edad, 
-                      string fechaNac, string ocupacion, string genero) {
-    Persona* p = new Persona;
-    p->id = id;
-    p->nombre = nombre;
-    p->apellido = apellido;
-    p->edad = edad;
-    p->fechaNacimiento = fechaNac;
-    p->ocupacion = ocupacion;
-    p->genero = genero;
-    p->izq = NULL;   // Inicialmente no tiene hijos
-    p->der = NULL;
-    return p;
-}
+// Registro activo, o NULL si el programa se abrió sin --registro
+RegistroCambios* registroActivo = NULL;
 
-// Busca a una persona por su ID mediante recorrido del rbol
-Persona* buscar(Persona* raiz, int id) {
-    if (raiz == NULL) return NULL;         // rbol vaco o nodo inexistente
-    if (raiz->id == id) return raiz;       // Nodo encontrado
+// Anota una persona agregada al árbol
+void anotarAlta(OperacionRegistro op, const Persona* p, int idPadre = 0, char lado = 0) {
+    if (registroActivo) registrarAlta(*registroActivo, op, p, idPadre, lado);
+}
 
-    // Buscar recursivamente en el hijo izquierdo
-    Persona* encontrado = buscar(raiz->izq, id);
-    if (encontrado != NULL) return encontrado;
+// Anota una eliminación o la limpieza del árbol
+void anotarBaja(OperacionRegistro op, int id) {
+    if (registroActivo) registrarBaja(*registroActivo, op, id);
+}
 
-    // Si no se encontr en la izquierda, buscar en la derecha
-    return buscar(raiz->der, id);
+// Los cambios masivos (generar, cargar, importar, reorganizar) no se anotan
+// persona por persona: se guarda un checkpoint con el árbol completo
+void anotarCambioMasivo(Persona* raiz) {
+    if (registroActivo) checkpointRegistro(*registroActivo, raiz);
 }
 
+// ---------------------
+// Presentación de personas
+// ---------------------
+
 // Muestra todos los datos de una persona en formato de ficha
 void mostrarPersonaDetalle(Persona* p) {
-    cout << "\n+--------------- INFORMACIN PERSONAL ---------------+\n";
-    cout << " ID:                " << setw(30) << left << p->id << "\n";
-    cout << " Nombre Completo:   " << setw(30) << left << (p->nombre + " " + p->apellido) << "\n";
-    cout << " Edad:              " << setw(30) << left << p->edad << "\n";
-    cout << " Fecha Nacimiento:  " << setw(30) << left << p->fechaNacimiento << "\n";
-    cout << " Ocupacin:         " << setw(30) << left << p->ocupacion << "\n";
-    cout << " Gnero:            " << setw(30) << left << p->genero << "\n";
+    cout << "\n+--------------- INFORMACIÓN PERSONAL ---------------+\n";
+    cout << "¦ ID:                " << setw(30) << left << p->id << "¦\n";
+    cout << "¦ Nombre Completo:   " << setw(30) << left << (p->nombre + " " + p->apellido) << "¦\n";
+    cout << "¦ Edad:              " << setw(30) << left << p->edad << "¦\n";
+    cout << "¦ Fecha Nacimiento:  " << setw(30) << left << p->fechaNacimiento << "¦\n";
+    cout << "¦ Ocupación:         " << setw(30) << left << p->ocupacion << "¦\n";
+    cout << "¦ Género:            " << setw(30) << left << p->genero << "¦\n";
     cout << "+----------------------------------------------------+\n";
 }
 
-// Inserta un hijo izquierdo o derecho segn la letra indicada
-bool insertarHijo(Persona* raiz, int idPadre, Persona* nuevoHijo, char lado) {
-    // Buscar al padre en el rbol
-    Persona* padre = buscar(raiz, idPadre);
-    if (padre == NULL) {
-        cout << " No existe una persona con ID " << idPadre << "\n";
-        return false;
-    }
+// Cantidad de resultados que muestran las búsquedas por nombre
+const int RESULTADOS_POR_NOMBRE = 20;
 
-    // Insertar como hijo izquierdo
-    if (lado == 'I' || lado == 'i') {
-        if (padre->izq != NULL) {
-            cout << " Advertencia: Se reemplazar el hijo izquierdo existente.\n";
-        }
-        padre->izq = nuevoHijo;
-        cout << " Hijo izquierdo agregado correctamente.\n";
-        return true;
-    }
-    // Insertar como hijo derecho
-    else if (lado == 'D' || lado == 'd') {
-        if (padre->der != NULL) {
-            cout << " Advertencia: Se reemplazar el hijo derecho existente.\n";
-        }
-        padre->der = nuevoHijo;
-        cout << " Hijo derecho agregado correctamente.\n";
-        return true;
-    }
+// Orden por ID para mostrar los resultados de los índices secundarios
+bool compararPorID(const Persona* a, const Persona* b) {
+    return a->id < b->id;
+}
 
-    // Si se ingres una letra invlida
-    cout << " Lado invlido. Use 'I' para izquierda o 'D' para derecha.\n";
-    return false;
+// Muestra una línea por persona encontrada, ordenadas por ID
+void mostrarPersonasEncontradas(vector<Persona*> personas) {
+    sort(personas.begin(), personas.end(), compararPorID);
+    cout << "\n Personas encontradas: " << personas.size() << "\n";
+    for (size_t i = 0; i < personas.size(); i++)
+        cout << "  • " << personas[i]->nombre << " " << personas[i]->apellido
+             << " (ID:" << personas[i]->id << ", " << personas[i]->edad << " años, "
+             << personas[i]->ocupacion << ")\n";
 }
 
-// Muestra los hijos izquierdo y derecho de una persona especfica
+// Muestra los hijos izquierdo y derecho de una persona específica
 void mostrarHijos(Persona* raiz, int id) {
     // Buscar a la persona por ID
     Persona* persona = buscar(raiz, id);
@@ -143,7 +110,7 @@ void mostrarHijos(Persona* raiz, int id) {
     cout << "\n+------------------- HIJOS ----------------------+\n";
     
     // Mostrar hijo izquierdo si existe
-    cout << " Hijo Izquierdo:  ";
+    cout << "¦ Hijo Izquierdo:  ";
     if (persona->izq != NULL)
         cout << persona->izq->nombre << " " << persona->izq->apellido 
              << " (ID: " << persona->izq->id << ")" << endl;
@@ -151,7 +118,7 @@ void mostrarHijos(Persona* raiz, int id) {
         cout << "NINGUNO" << endl;
 
     // Mostrar hijo derecho si existe
-    cout << " Hijo Derecho:    ";
+    cout << "¦ Hijo Derecho:    ";
     if (persona->der != NULL)
         cout << persona->der->nombre << " " << persona->der->apellido 
              << " (ID: " << persona->der->id << ")" << endl;
@@ -161,231 +128,223 @@ void mostrarHijos(Persona* raiz, int id) {
     cout << "+------------------------------------------------+\n";
 }
 
-// Libera toda la memoria del rbol en forma recursiva
-void eliminarArbol(Persona* raiz) {
-    if (raiz == NULL) return;
-    
-    // Primero elimina subrbol izquierdo
-    eliminarArbol(raiz->izq);
-    // Luego subrbol derecho
-    eliminarArbol(raiz->der);
-    // Finalmente elimina el nodo actual
-    delete raiz;
-}
+// Imprime el árbol gráficamente en forma horizontal.
+// Es un in-orden invertido (der -> raíz -> izq) con pila explícita.
+void imprimirArbol(Persona* raiz) {
+    // Cada marco guarda el nodo, su nivel y de qué lado cuelga
+    struct Marco {
+        Persona* nodo;
+        int nivel;
+        const char* lado;
+    };
+
+    Pila<Marco> pila;
+    Marco actual = { raiz, 0, "RAÍZ" };
+
+    while (actual.nodo != NULL || !pila.vacia()) {
+        // Bajar por la derecha (se muestra arriba)
+        while (actual.nodo != NULL) {
+            pila.apilar(actual);
+            Marco der = { actual.nodo->der, actual.nivel + 1, "DER" };
+            actual = der;
+        }
+
+        // Imprime el nodo actual con indentación adecuada
+        Marco m = pila.desapilar();
+        cout << "\n";
+        for (int i = 0; i < m.nivel * 10; i++)
+            cout << " ";
 
-// Elimina una persona especfica del rbol junto con todos sus descendientes
-Persona* eliminarPersona(Persona* raiz, int id) {
-    if (raiz == NULL) return NULL;
+        cout << "[" << m.lado << "] " << m.nodo->id << ": " << m.nodo->nombre
+             << " " << m.nodo->apellido << " (" << m.nodo->edad << " años)";
 
-    // Si se encuentra el nodo a eliminar
-    if (raiz->id == id) {
-        eliminarArbol(raiz);  // Elimina el subrbol completo
-        return NULL;          // Retorna nulo para desconectar este nodo
+        // Luego continúa por el lado izquierdo (abajo)
+        Marco izq = { m.nodo->izq, m.nivel + 1, "IZQ" };
+        actual = izq;
     }
-    
-    // Contina buscando recursivamente en los hijos
-    raiz->izq = eliminarPersona(raiz->izq, id);
-    raiz->der = eliminarPersona(raiz->der, id);
-    
-    return raiz; // Retorna el rbol actualizado
 }
 
-// Imprime el rbol grficamente en forma horizontal
-void imprimirArbol(Persona* raiz, int espacio = 0, string lado = "RAZ") {
-    if (raiz == NULL) return;
-
-    // Aumenta el espaciado entre niveles del rbol
-    espacio += 10;
+// ---------------------
+// Recorridos genéricos
+// ---------------------
 
-    // Primero imprime el lado derecho (se muestra arriba)
-    imprimirArbol(raiz->der, espacio, "DER");
-    
-    // Imprime el nodo actual con indentacin adecuada
-    cout << "\n";
-    for (int i = 10; i < espacio; i++)
-        cout << " ";
-    
-    cout << "[" << lado << "] " << raiz->id << ": " << raiz->nombre 
-         << " " << raiz->apellido << " (" << raiz->edad << " aos)";
-    
-    // Luego imprime el lado izquierdo (abajo)
-    imprimirArbol(raiz->izq, espacio, "IZQ");
+// Muestra una persona en una línea (formato de los recorridos)
+template <class Arbol>
+void mostrarLinea(const Arbol& a, typename Arbol::Nodo n) {
+    cout << "  • " << a.nombre(n) << " " << a.apellido(n) 
+         << " (ID:" << a.id(n) << ", " << a.edad(n) << " años)\n";
 }
 
-// Recorrido en PRE-ORDEN: raz ? izquierda ? derecha
-void preOrden(Persona* raiz) {
-    if (raiz == NULL) return;
-
-    // Primero se muestra la raz
-    cout << "   " << raiz->nombre << " " << raiz->apellido 
-         << " (ID:" << raiz->id << ", " << raiz->edad << " aos)\n";
-
-    // Luego subrbol izquierdo
-    preOrden(raiz->izq);
-    // Despus subrbol derecho
-    preOrden(raiz->der);
+// Recorrido en PRE-ORDEN: raíz -> izquierda -> derecha
+template <class Arbol>
+void preOrden(const Arbol& a) {
+    recorrerPreOrden(a, [&a](typename Arbol::Nodo n) { mostrarLinea(a, n); });
 }
 
-// Recorrido IN-ORDEN: izquierda ? raz ? derecha
-void inOrden(Persona* raiz) {
-    if (raiz == NULL) return;
-
-    // Subrbol izquierdo
-    inOrden(raiz->izq);
-
-    // Imprime la raz
-    cout << "   " << raiz->nombre << " " << raiz->apellido 
-         << " (ID:" << raiz->id << ", " << raiz->edad << " aos)\n";
+// Recorrido IN-ORDEN: izquierda -> raíz -> derecha
+template <class Arbol>
+void inOrden(const Arbol& a) {
+    recorrerInOrden(a, [&a](typename Arbol::Nodo n) { mostrarLinea(a, n); });
+}
 
-    // Subrbol derecho
-    inOrden(raiz->der);
+// Recorrido POST-ORDEN: izquierda -> derecha -> raíz
+template <class Arbol>
+void postOrden(const Arbol& a) {
+    recorrerPostOrden(a, [&a](typename Arbol::Nodo n) { mostrarLinea(a, n); });
 }
 
-// Recorrido POST-ORDEN: izquierda ? derecha ? raz
-void postOrden(Persona* raiz) {
-    if (raiz == NULL) return;
+// Versiones sobre el árbol de punteros (usadas por los menús)
+void preOrden(Persona* raiz)  { preOrden(VistaPersonas(raiz)); }
+void inOrden(Persona* raiz)   { inOrden(VistaPersonas(raiz)); }
+void postOrden(Persona* raiz) { postOrden(VistaPersonas(raiz)); }
 
-    // Subrbol izquierdo
-    postOrden(raiz->izq);
-    // Subrbol derecho
-    postOrden(raiz->der);
+// ---------------------
+// Estadísticas
+// ---------------------
 
-    // Finalmente se muestra la raz
-    cout << "   " << raiz->nombre << " " << raiz->apellido 
-         << " (ID:" << raiz->id << ", " << raiz->edad << " aos)\n";
+// Imprime la pantalla de estadísticas a partir de los totales ya calculados
+void imprimirEstadisticas(int total, int altura, long long sumaEdades, const int generos[3],
+                          const string& nombreRaiz, const string& apellidoRaiz) {
+    const char* nombresGenero[3] = { "Masculino", "Femenino", "Otro" };
+    int predominante = 0;
+    for (int g = 1; g < 3; g++)
+        if (generos[g] > generos[predominante]) predominante = g;
+
+    mostrarEncabezado("ESTADÍSTICAS DEL ÁRBOL");
+
+    cout << "  • Total de personas:      " << total << endl;
+    cout << "  • Altura del árbol:       " << altura << " niveles" << endl;
+    cout << "  • Generaciones:           " << altura << endl;
+    cout << "  • Promedio de edad:       " << fixed << setprecision(1)
+         << (double)sumaEdades / total << " años" << endl;
+    cout << "  • Género predominante:    " << nombresGenero[predominante] << endl;
+    cout << "  • Raíz (Patriarca):       " << nombreRaiz << " " << apellidoRaiz << endl;
 }
 
-// Inserta una persona en un rbol Binario de Bsqueda (ABB) segn su ID
-Persona* insertarABB(Persona* raiz, Persona* nueva) {
-    // Si el rbol est vaco, la nueva persona se convierte en la raz
-    if (raiz == NULL) return nueva;
-
-    // Si el ID es menor, insertar en el subrbol izquierdo
-    if (nueva->id < raiz->id) {
-        raiz->izq = insertarABB(raiz->izq, nueva);
-    }
-    // Si el ID es mayor, insertar en el subrbol derecho
-    else if (nueva->id > raiz->id) {
-        raiz->der = insertarABB(raiz->der, nueva);
+// Muestra estadísticas generales del árbol recorriéndolo (cualquier vista)
+template <class Arbol>
+void mostrarEstadisticas(const Arbol& a) {
+    typedef typename Arbol::Nodo Nodo;
+    if (a.raiz() == a.nulo()) {
+        cout << " El árbol está vacío.\n";
+        return;
     }
-    // Si el ID ya existe, se descarta la insercin
-    else {
-        cout << " El ID ya existe en el rbol.\n";
-        delete nueva; // Se elimina para evitar fugas de memoria
+
+    // Edades y géneros en un solo recorrido
+    long long sumaEdades = 0;
+    int generos[3] = { 0, 0, 0 };
+    int total = 0;
+    Pila<Nodo> pila;
+    pila.apilar(a.raiz());
+    while (!pila.vacia()) {
+        Nodo actual = pila.desapilar();
+        total++;
+        sumaEdades += a.edad(actual);
+        generos[a.genero(actual)]++;
+        if (a.izq(actual) != a.nulo()) pila.apilar(a.izq(actual));
+        if (a.der(actual) != a.nulo()) pila.apilar(a.der(actual));
     }
 
-    return raiz; // Se retorna la raz actual del ABB
+    imprimirEstadisticas(total, calcularAltura(a), sumaEdades, generos,
+                         a.nombre(a.raiz()), a.apellido(a.raiz()));
 }
 
-// Genera un rbol genealgico ficticio para pruebas
-Persona* generarArbolFicticio() {
-    // Crear raz del rbol
-    Persona* raiz = crearPersona(1, "Carlos", "Gonzlez", 75, "15/03/1950", "Jubilado", "Masculino");
-    
-    // Hijos directos
-    raiz->izq = crearPersona(2, "Mara", "Gonzlez", 50, "22/07/1975", "Doctora", "Femenino");
-    raiz->der = crearPersona(3, "Roberto", "Gonzlez", 48, "10/11/1977", "Ingeniero", "Masculino");
-    
-    // Nietos por lado izquierdo
-    raiz->izq->izq = crearPersona(4, "Ana", "Rodrguez", 28, "05/01/1997", "Abogada", "Femenino");
-    raiz->izq->der = crearPersona(5, "Pedro", "Rodrguez", 25, "18/09/2000", "Estudiante", "Masculino");
-    
-    // Nietos por lado derecho
-    raiz->der->izq = crearPersona(6, "Sofa", "Gonzlez", 22, "30/04/2003", "Diseadora", "Femenino");
-    raiz->der->der = crearPersona(7, "Luis", "Gonzlez", 20, "12/12/2005", "Estudiante", "Masculino");
-    
-    // Bisnietos
-    raiz->izq->izq->izq = crearPersona(8, "Emma", "Lpez", 5, "08/06/2020", "Preescolar", "Femenino");
-    raiz->izq->izq->der = crearPersona(9, "Lucas", "Lpez", 3, "20/02/2022", "Preescolar", "Masculino");
-    
-    raiz->izq->der->izq = crearPersona(10, "Ma", "Rodrguez", 2, "14/08/2023", "N/A", "Femenino");
-    
-    return raiz; // Retorna el rbol listo
+// En el árbol de punteros la raíz ya guarda los agregados: O(1)
+void mostrarEstadisticas(Persona* raiz) {
+    if (raiz == NULL) {
+        cout << " El árbol está vacío.\n";
+        return;
+    }
+    imprimirEstadisticas(raiz->tamano, raiz->altura, raiz->sumaEdades, raiz->generos,
+                         raiz->nombre, raiz->apellido);
 }
 
-// Guarda recursivamente la estructura del rbol en un archivo de texto
-void guardarEnArchivo(Persona* raiz, ofstream& archivo, int nivel = 0) {
-    if (raiz == NULL) return;
+// ------------------------------------------------------
+// Imagen de solo lectura (.ari) para abrir con mmap
+// ------------------------------------------------------
 
-    // ndentacin para mostrar estructura jerrquica
-    for (int i = 0; i < nivel; i++) archivo << "    ";
-    
-    // Guardar informacin del nodo actual
-    archivo << "+- ID: " << raiz->id << " | " << raiz->nombre << " " << raiz->apellido 
-            << " | Edad: " << raiz->edad << " aos | " << raiz->ocupacion << endl;
-    
-    // Si tiene hijo izquierdo, guardarlo recursivamente
-    if (raiz->izq != NULL) {
-        for (int i = 0; i < nivel; i++) archivo << "    ";
-        archivo << "  [Hijo Izquierdo]" << endl;
-        guardarEnArchivo(raiz->izq, archivo, nivel + 1);
-    }
-    
-    // Si tiene hijo derecho, guardarlo recursivamente
-    if (raiz->der != NULL) {
-        for (int i = 0; i < nivel; i++) archivo << "    ";
-        archivo << "  [Hijo Derecho]" << endl;
-        guardarEnArchivo(raiz->der, archivo, nivel + 1);
-    }
+// Escribe una cadena de la imagen sin copiarla
+void mostrarCadenaImagen(const ImagenArbol& img, CadenaImagen c) {
+    if ((uint64_t)c.offset + c.largo <= img.enc->tamCadenas)
+        cout.write(img.cadenas + c.offset, c.largo);
 }
 
-// Funcin que controla la escritura del rbol en archivo
-bool guardarArbolEnArchivo(Persona* raiz, string nombreArchivo) {
-    ofstream archivo(nombreArchivo.c_str());
-    
-    if (!archivo.is_open()) return false; // Error al abrir archivo
-    
-    archivo << "-------------------------------------------------------\n";
-    archivo << "          RBOL GENEALGICO FAMILIAR\n";
-    archivo << "-------------------------------------------------------\n\n";
-    
-    if (raiz == NULL) {
-        archivo << "El rbol est vaco.\n";
-    } else {
-        archivo << "[RAZ DEL RBOL]\n";
-        guardarEnArchivo(raiz, archivo, 0); // Guardado recursivo
-    }
-    
-    archivo << "\n-------------------------------------------------------\n";
-    archivo.close();
-    return true; // Guardado exitoso
+// Muestra a una persona de la imagen en una línea
+void mostrarLineaImagen(const ImagenArbol& img, uint32_t indice) {
+    const NodoImagen& n = img.nodos[indice];
+    cout << "  • ";
+    mostrarCadenaImagen(img, n.nombre);
+    cout << " ";
+    mostrarCadenaImagen(img, n.apellido);
+    cout << " (ID:" << n.id << ", " << n.edad << " años)\n";
 }
 
-// Cuenta cuntos nodos existen en el rbol
-int contarNodos(Persona* raiz) {
-    if (raiz == NULL) return 0;
-    return 1 + contarNodos(raiz->izq) + contarNodos(raiz->der);
+// Ficha completa de una persona de la imagen
+void mostrarDetalleImagen(const ImagenArbol& img, uint32_t indice) {
+    const NodoImagen& n = img.nodos[indice];
+    cout << "\n  ID:                " << n.id;
+    cout << "\n  Nombre Completo:   "; mostrarCadenaImagen(img, n.nombre);
+    cout << " ";                       mostrarCadenaImagen(img, n.apellido);
+    cout << "\n  Edad:              " << n.edad;
+    cout << "\n  Fecha Nacimiento:  "; mostrarCadenaImagen(img, n.fechaNacimiento);
+    cout << "\n  Ocupación:         "; mostrarCadenaImagen(img, n.ocupacion);
+    cout << "\n  Género:            "; mostrarCadenaImagen(img, n.genero);
+    cout << "\n";
 }
 
-// Calcula la altura del rbol (profundidad mxima)
-int calcularAltura(Persona* raiz) {
-    if (raiz == NULL) return 0;
-
-    int altIzq = calcularAltura(raiz->izq);
-    int altDer = calcularAltura(raiz->der);
+// Muestra los hijos de una persona de la imagen
+void mostrarHijosImagen(const ImagenArbol& img, int id) {
+    uint32_t indice = buscarEnImagen(img, id);
+    if (indice == IMAGEN_NINGUNO) {
+        cout << " No existe una persona con ese ID.\n";
+        return;
+    }
+    mostrarDetalleImagen(img, indice);
+
+    const NodoImagen& n = img.nodos[indice];
+    cout << "\n  Hijo Izquierdo:";
+    if (n.izq != IMAGEN_NINGUNO) mostrarLineaImagen(img, n.izq);
+    else cout << "  NINGUNO\n";
+    cout << "  Hijo Derecho:";
+    if (n.der != IMAGEN_NINGUNO) mostrarLineaImagen(img, n.der);
+    else cout << "  NINGUNO\n";
+}
 
-    return 1 + (altIzq > altDer ? altIzq : altDer);
+// Muestra la imagen recorrida en el orden pedido, una persona por línea
+void mostrarRecorridoImagen(const ImagenArbol& img, OrdenRecorrido orden) {
+    recorrerImagen(img, orden, [&img](uint32_t indice) { mostrarLineaImagen(img, indice); });
 }
 
-// Muestra estadsticas generales del rbol
-void mostrarEstadisticas(Persona* raiz) {
-    if (raiz == NULL) {
-        cout << " El rbol est vaco.\n";
+// Estadísticas leídas directamente del encabezado (O(1))
+void mostrarEstadisticasImagen(const ImagenArbol& img) {
+    const EncabezadoImagen& e = *img.enc;
+    if (e.nodos == 0) {
+        cout << " La imagen está vacía.\n";
         return;
     }
-    
-    mostrarEncabezado("ESTADSTICAS DEL RBOL");
 
-    cout << "   Total de personas:      " << contarNodos(raiz) << endl;
-    cout << "   Altura del rbol:       " << calcularAltura(raiz) << " niveles" << endl;
-    cout << "   Generaciones:           " << calcularAltura(raiz) << endl;
-    cout << "   Raz (Patriarca):       " << raiz->nombre << " " << raiz->apellido << endl;
+    const char* nombresGenero[3] = { "Masculino", "Femenino", "Otro" };
+    int predominante = 0;
+    for (int g = 1; g < 3; g++)
+        if (e.generos[g] > e.generos[predominante]) predominante = g;
+
+    mostrarEncabezado("ESTADÍSTICAS DE LA IMAGEN");
+    cout << "   Total de personas:      " << e.nodos << endl;
+    cout << "   Altura del árbol:       " << e.altura << " niveles" << endl;
+    cout << "   Promedio de edad:       " << fixed << setprecision(1)
+         << (double)e.sumaEdades / e.nodos << " años" << endl;
+    cout << "   Género predominante:    " << nombresGenero[predominante] << endl;
+    cout << "   Raíz (Patriarca):       ";
+    mostrarCadenaImagen(img, img.nodos[0].nombre);
+    cout << " ";
+    mostrarCadenaImagen(img, img.nodos[0].apellido);
+    cout << endl;
 }
 
-
 // ------------------------------------------------------
 // Entrada de Datos - Registro completo de una persona
 // ------------------------------------------------------
+
 Persona* ingresarPersonaCompleta(int id) {
     string nombre, apellido, fechaNac, ocupacion, genero;
     int edad;
@@ -401,11 +360,11 @@ Persona* ingresarPersonaCompleta(int id) {
     getline(cin, apellido);
     
     // ----------------------------
-    // Validacin de Edad
+    // Validación de Edad
     // ----------------------------
     cout << "Edad: ";
-    while (!(cin >> edad) || edad < 0 || edad > 120) {
-        cout << " Edad invlida. Ingrese un valor entre 0 y 120: ";
+    while (!(cin >> edad) || !edadValida(edad)) {
+        cout << " Edad inválida. Ingrese un valor entre 0 y 120: ";
         limpiarEntrada();
     }
     limpiarEntrada(); // Limpiar buffer
@@ -414,21 +373,20 @@ Persona* ingresarPersonaCompleta(int id) {
     cout << "Fecha de Nacimiento (DD/MM/AAAA): ";
     getline(cin, fechaNac);
     
-    // Solicitar ocupacin
-    cout << "Ocupacin: ";
+    // Solicitar ocupación
+    cout << "Ocupación: ";
     getline(cin, ocupacion);
     
     // ----------------------------
-    // Validacin de Gnero
+    // Validación de Género
     // ----------------------------
-    cout << "Gnero (Masculino/Femenino): ";
+    cout << "Género (Masculino/Femenino): ";
     getline(cin, genero);
 
-    // Validar entrada correcta del gnero
-    while (genero != "Masculino" && genero != "Femenino" &&
-           genero != "masculino" && genero != "femenino") 
+    // Validar entrada correcta del género
+    while (!generoValido(genero)) 
     {
-        cout << " Gnero invlido. Debe ser Masculino o Femenino: ";
+        cout << " Género inválido. Debe ser Masculino o Femenino: ";
         getline(cin, genero);
     }
 
@@ -437,22 +395,25 @@ Persona* ingresarPersonaCompleta(int id) {
 }
 
 // ------------------------------------------------------
-// Submen para insertar personas en el rbol genealgico
+// Submenú para insertar personas en el árbol genealógico
 // ------------------------------------------------------
+
 void submenuInsertar(Persona*& raiz) {
     int opcion;
     do {
         limpiarPantalla();
-        mostrarEncabezado("SUBMEN - INSERTAR PERSONAS");
+        mostrarEncabezado("SUBMENÚ - INSERTAR PERSONAS");
 
-        // Opciones del submen
-        cout << "  1. Crear raz (patriarca/matriarca)\n";
+        // Opciones del submenú
+        cout << "  1. Crear raíz (patriarca/matriarca)\n";
         cout << "  2. Agregar hijo manualmente\n";
-        cout << "  3. Insertar usando rbol binario de bsqueda (ABB)\n";
-        cout << "  4. Volver al men principal\n";
-        cout << "\nSeleccione una opcin: ";
+        cout << "  3. Insertar usando árbol binario de búsqueda (ABB)\n";
+        cout << "  4. Insertar usando ABB balanceado (AVL)\n";
+        cout << "  5. Reorganizar como ABB balanceado por ID\n";
+        cout << "  6. Volver al menú principal\n";
+        cout << "\nSeleccione una opción: ";
         
-        // Validacin de opcin ingresada
+        // Validación de opción ingresada
         if (!(cin >> opcion)) {
             limpiarEntrada();
             continue;
@@ -460,20 +421,20 @@ void submenuInsertar(Persona*& raiz) {
         limpiarEntrada();
         
         // ----------------------------
-        // Opcin 1: Crear raz del rbol
+        // Opción 1: Crear raíz del árbol
         // ----------------------------
         if (opcion == 1) {
             if (raiz != NULL) {
-                cout << " Ya existe una raz en el rbol.\n";
+                cout << " Ya existe una raíz en el árbol.\n";
                 pausar();
                 continue;
             }
             
             int idRaiz;
 
-            cout << "ID de la raz: ";
+            cout << "ID de la raíz: ";
             if (!(cin >> idRaiz)) {
-                cout << " ID invlido.\n";
+                cout << " ID inválido.\n";
                 limpiarEntrada();
                 pausar();
                 continue;
@@ -482,22 +443,24 @@ void submenuInsertar(Persona*& raiz) {
             
             // Validar que el ID sea positivo
             if (idRaiz <= 0) {
-                cout << " El ID debe ser un nmero entero positivo.\n";
+                cout << " El ID debe ser un número entero positivo.\n";
                 pausar();
                 continue;
             }
             
-            // Registrar los datos completos de la persona raz
+            // Registrar los datos completos de la persona raíz
             raiz = ingresarPersonaCompleta(idRaiz);
-            cout << "\n Raz del rbol creada exitosamente!\n";
+            tipoArbol = ARBOL_GENEALOGICO;
+            anotarAlta(REGISTRO_RAIZ, raiz);
+            cout << "\n Raíz del árbol creada exitosamente!\n";
         }
 
         // ----------------------------
-        // Opcin 2: Insertar hijo manualmente (izq/der)
+        // Opción 2: Insertar hijo manualmente (izq/der)
         // ----------------------------
         else if (opcion == 2) {
             if (!raiz) {
-                cout << " Primero debe crear la raz del rbol.\n";
+                cout << " Primero debe crear la raíz del árbol.\n";
                 pausar();
                 continue;
             }
@@ -508,14 +471,14 @@ void submenuInsertar(Persona*& raiz) {
             // Ingresar ID del padre
             cout << "ID del padre/madre: ";
             if (!(cin >> idPadre)) {
-                cout << " ID invlido.\n";
+                cout << " ID inválido.\n";
                 limpiarEntrada();
                 pausar();
                 continue;
             }
             limpiarEntrada();
             
-            // Verificar que exista en el rbol
+            // Verificar que exista en el árbol
             if (!buscar(raiz, idPadre)) {
                 cout << " No existe una persona con ese ID.\n";
                 pausar();
@@ -525,16 +488,16 @@ void submenuInsertar(Persona*& raiz) {
             // Ingresar ID del hijo
             cout << "ID del nuevo hijo: ";
             if (!(cin >> idHijo)) {
-                cout << " ID invlido.\n";
+                cout << " ID inválido.\n";
                 limpiarEntrada();
                 pausar();
                 continue;
             }
             limpiarEntrada();
             
-            // Validacin de ID repetido
+            // Validación de ID repetido
             if (buscar(raiz, idHijo)) {
-                cout << " Ese ID ya existe en el rbol.\n";
+                cout << " Ese ID ya existe en el árbol.\n";
                 pausar();
                 continue;
             }
@@ -543,15 +506,27 @@ void submenuInsertar(Persona*& raiz) {
             Persona* nuevo = ingresarPersonaCompleta(idHijo);
             
             // Elegir si va a la izquierda o derecha
-            cout << "\nPosicin (I=Izquierda, D=Derecha): ";
+            cout << "\nPosición (I=Izquierda, D=Derecha): ";
             cin >> lado;
             limpiarEntrada();
             
-            insertarHijo(raiz, idPadre, nuevo, lado);
+            EstadoArbol estado = insertarHijo(raiz, idPadre, nuevo, lado);
+            if (estado == ESTADO_OK || estado == ESTADO_REEMPLAZADO) {
+                const char* nombreLado = (lado == 'I' || lado == 'i') ? "izquierdo" : "derecho";
+                if (estado == ESTADO_REEMPLAZADO)
+                    cout << " Advertencia: Se reemplazó el hijo " << nombreLado << " existente.\n";
+                cout << " Hijo " << nombreLado << " agregado correctamente.\n";
+                tipoArbol = ARBOL_GENEALOGICO;  // Ya no respeta el orden ABB
+                anotarAlta(REGISTRO_HIJO, nuevo, idPadre, lado);
+            } else {
+                // Si no se pudo enlazar, liberar la persona creada
+                cout << " " << mensajeEstado(estado) << "\n";
+                liberarPersona(nuevo);
+            }
         }
 
         // ----------------------------
-        // Opcin 3: Insertar usando ABB
+        // Opción 3: Insertar usando ABB
         // ----------------------------
         else if (opcion == 3) {
             int id;
@@ -559,7 +534,7 @@ void submenuInsertar(Persona*& raiz) {
             // Ingresar ID del nuevo nodo
             cout << "ID de la nueva persona: ";
             if (!(cin >> id)) {
-                cout << " ID invlido.\n";
+                cout << " ID inválido.\n";
                 limpiarEntrada();
                 pausar();
                 continue;
@@ -576,58 +551,141 @@ void submenuInsertar(Persona*& raiz) {
             // Ingresar datos completos de la persona
             Persona* nuevo = ingresarPersonaCompleta(id);
 
-            // Insertar segn reglas de rbol binario de bsqueda
+            // Un AVL que recibe una inserción sin balancear pasa a ser ABB
+            if (raiz == NULL || tipoArbol == ARBOL_AVL)
+                tipoArbol = ARBOL_ABB;
+
+            // Insertar según reglas de árbol binario de búsqueda
             raiz = insertarABB(raiz, nuevo);
+            anotarAlta(REGISTRO_ABB, nuevo);
 
             cout << "\n Persona insertada usando reglas de ABB.\n";
         }
+
+        // ----------------------------
+        // Opción 4: Insertar usando ABB balanceado (AVL)
+        // ----------------------------
+        else if (opcion == 4) {
+            // Solo se puede balancear un árbol vacío o que ya sea AVL
+            if (raiz != NULL && tipoArbol != ARBOL_AVL) {
+                cout << " El árbol actual no es un AVL. Límpielo primero (opción 5).\n";
+                pausar();
+                continue;
+            }
+
+            int id;
+
+            // Ingresar ID del nuevo nodo
+            cout << "ID de la nueva persona: ";
+            if (!(cin >> id)) {
+                cout << " ID inválido.\n";
+                limpiarEntrada();
+                pausar();
+                continue;
+            }
+            limpiarEntrada();
+            
+            // Verificar duplicados
+            if (buscar(raiz, id)) {
+                cout << " Ese ID ya existe.\n";
+                pausar();
+                continue;
+            }
+            
+            // Ingresar datos completos de la persona
+            Persona* nuevo = ingresarPersonaCompleta(id);
+
+            // Insertar y rebalancear con rotaciones
+            raiz = insertarAVL(raiz, nuevo);
+            tipoArbol = ARBOL_AVL;
+            anotarAlta(REGISTRO_AVL, nuevo);
+
+            cout << "\n Persona insertada en el AVL (altura actual: " << alturaNodo(raiz) << ").\n";
+        }
+
+        // ----------------------------
+        // Opción 5: Reorganizar el árbol como ABB de altura mínima
+        // ----------------------------
+        else if (opcion == 5) {
+            if (!raiz) {
+                cout << " El árbol está vacío.\n";
+                pausar();
+                continue;
+            }
+            
+            // Las relaciones padre/hijo se pierden: pedir confirmación
+            if (tipoArbol == ARBOL_GENEALOGICO) {
+                char resp;
+                cout << " Se perderán las relaciones familiares. ¿Continuar? (S/N): ";
+                cin >> resp;
+                limpiarEntrada();
+                if (resp != 'S' && resp != 's') {
+                    cout << "Operación cancelada.\n";
+                    pausar();
+                    continue;
+                }
+            }
+            
+            raiz = rebalancearComoABB(raiz);
+            tipoArbol = ARBOL_AVL;   // Un ABB de altura mínima ya está balanceado
+            anotarCambioMasivo(raiz);
+            cout << "\n Árbol reorganizado (altura actual: " << alturaNodo(raiz) << ").\n";
+        }
         
-        // Pausa despus de cada operacin
-        if (opcion >= 1 && opcion <= 3) pausar();
+        // Pausa después de cada operación
+        if (opcion >= 1 && opcion <= 5) pausar();
         
-    } while (opcion != 4); // Volver al men principal
+    } while (opcion != 6); // Volver al menú principal
 }
 
-
 // ------------------------------------------------------
-// Submen de Consultas
+// Submenú de Consultas
 // ------------------------------------------------------
+
 void submenuConsultar(Persona* raiz) {
     int opcion;
     do {
         limpiarPantalla();
-        mostrarEncabezado("SUBMEN - CONSULTAR INFORMACIN");
+        mostrarEncabezado("SUBMENÚ - CONSULTAR INFORMACIÓN");
 
         // Opciones de consulta
         cout << "  1. Buscar persona por ID\n";
         cout << "  2. Ver hijos de una persona\n";
-        cout << "  3. Mostrar rbol completo\n";
-        cout << "  4. Ver estadsticas del rbol\n";
-        cout << "  5. Volver al men principal\n";
-        cout << "\nSeleccione una opcin: ";
+        cout << "  3. Mostrar árbol completo\n";
+        cout << "  4. Ver estadísticas del árbol\n";
+        cout << "  5. Buscar por apellido\n";
+        cout << "  6. Buscar por ocupación\n";
+        cout << "  7. Buscar por género\n";
+        cout << "  8. Buscar por rango de edad\n";
+        cout << "  9. Buscar por nombre (comienzo)\n";
+        cout << " 10. Buscar nombres parecidos\n";
+        cout << " 11. Parentesco entre dos personas\n";
+        cout << " 12. Ver ancestros de una persona\n";
+        cout << " 13. Volver al menú principal\n";
+        cout << "\nSeleccione una opción: ";
         
-        // Validar entrada numrica
+        // Validar entrada numérica
         if (!(cin >> opcion)) {
             limpiarEntrada();
             continue;
         }
         limpiarEntrada();
         
-        // Validar que el rbol no est vaco (excepto si quiere salir)
-        if (raiz == NULL && opcion != 5) {
-            cout << " El rbol est vaco.\n";
+        // Validar que el árbol no esté vacío (excepto si quiere salir)
+        if (raiz == NULL && opcion != 13) {
+            cout << " El árbol está vacío.\n";
             pausar();
             continue;
         }
         
         // ----------------------------
-        // Opcin 1: Buscar persona por ID
+        // Opción 1: Buscar persona por ID
         // ----------------------------
         if (opcion == 1) {
             int id;
             cout << "ID a buscar: ";
             if (!(cin >> id)) {
-                cout << " ID invlido.\n";
+                cout << " ID inválido.\n";
                 limpiarEntrada();
                 pausar();
                 continue;
@@ -639,18 +697,18 @@ void submenuConsultar(Persona* raiz) {
             if (p) {
                 mostrarPersonaDetalle(p);
             } else {
-                cout << " No se encontr una persona con ese ID.\n";
+                cout << " No se encontró una persona con ese ID.\n";
             }
         }
 
         // ----------------------------
-        // Opcin 2: Ver hijos de una persona
+        // Opción 2: Ver hijos de una persona
         // ----------------------------
         else if (opcion == 2) {
             int id;
             cout << "ID de la persona: ";
             if (!(cin >> id)) {
-                cout << " ID invlido.\n";
+                cout << " ID inválido.\n";
                 limpiarEntrada();
                 pausar();
                 continue;
@@ -662,59 +720,197 @@ void submenuConsultar(Persona* raiz) {
         }
 
         // ----------------------------
-        // Opcin 3: Mostrar el rbol completo
+        // Opción 3: Mostrar el árbol completo
         // ----------------------------
         else if (opcion == 3) {
-            mostrarEncabezado("ESTRUCTURA DEL RBOL GENEALGICO");
+            mostrarEncabezado("ESTRUCTURA DEL ÁRBOL GENEALÓGICO");
             imprimirArbol(raiz);
             cout << "\n";
         }
 
         // ----------------------------
-        // Opcin 4: Ver estadsticas del rbol
+        // Opción 4: Ver estadísticas del árbol
         // ----------------------------
         else if (opcion == 4) {
             mostrarEstadisticas(raiz);
         }
+
+        // ----------------------------
+        // Opciones 5 a 7: Buscar por apellido, ocupación o género
+        // (índices secundarios: no recorren el árbol)
+        // ----------------------------
+        else if (opcion >= 5 && opcion <= 7) {
+            const char* campos[] = { "Apellido", "Ocupación", "Género (Masculino/Femenino/Otro)" };
+            string valor;
+            cout << campos[opcion - 5] << ": ";
+            getline(cin, valor);
+
+            if (opcion == 5)      mostrarPersonasEncontradas(buscarPorApellido(valor));
+            else if (opcion == 6) mostrarPersonasEncontradas(buscarPorOcupacion(valor));
+            else                  mostrarPersonasEncontradas(buscarPorGenero(valor));
+        }
+
+        // ----------------------------
+        // Opción 8: Buscar por rango de edad
+        // ----------------------------
+        else if (opcion == 8) {
+            int desde, hasta;
+            cout << "Edad mínima: ";
+            if (!(cin >> desde)) {
+                cout << " Edad inválida.\n";
+                limpiarEntrada();
+                pausar();
+                continue;
+            }
+            cout << "Edad máxima: ";
+            if (!(cin >> hasta)) {
+                cout << " Edad inválida.\n";
+                limpiarEntrada();
+                pausar();
+                continue;
+            }
+            limpiarEntrada();
+            mostrarPersonasEncontradas(buscarPorEdad(desde, hasta));
+        }
+
+        // ----------------------------
+        // Opción 9: Buscar por el comienzo del nombre o del apellido
+        // (sin distinguir mayúsculas ni acentos: "mar go" encuentra a
+        // "María Gómez")
+        // ----------------------------
+        else if (opcion == 9) {
+            string texto;
+            cout << "Comienzo del nombre y/o apellido: ";
+            getline(cin, texto);
+
+            vector<Persona*> encontradas = buscarNombresPorPrefijo(texto, RESULTADOS_POR_NOMBRE);
+            cout << "\n Personas encontradas: " << encontradas.size()
+                 << (encontradas.size() == (size_t)RESULTADOS_POR_NOMBRE ? " (primeras)" : "") << "\n";
+            for (size_t i = 0; i < encontradas.size(); i++)
+                cout << "  • " << encontradas[i]->nombre << " " << encontradas[i]->apellido
+                     << " (ID:" << encontradas[i]->id << ")\n";
+        }
+
+        // ----------------------------
+        // Opción 10: Buscar nombres parecidos (tolera errores de escritura)
+        // ----------------------------
+        else if (opcion == 10) {
+            string texto;
+            cout << "Nombre y/o apellido aproximado: ";
+            getline(cin, texto);
+
+            vector<CoincidenciaNombre> parecidas = buscarNombresParecidos(texto, RESULTADOS_POR_NOMBRE);
+            cout << "\n Personas parecidas: " << parecidas.size() << "\n";
+            for (size_t i = 0; i < parecidas.size(); i++)
+                cout << "  • " << parecidas[i].persona->nombre << " " << parecidas[i].persona->apellido
+                     << " (ID:" << parecidas[i].persona->id << ", parecido "
+                     << (int)(parecidas[i].puntaje * 100 + 0.5) << "%)\n";
+        }
+        
+        // ----------------------------
+        // Opción 11: Parentesco entre dos personas (ancestro común)
+        // ----------------------------
+        else if (opcion == 11) {
+            int idA, idB;
+            cout << "ID de la primera persona: ";
+            if (!(cin >> idA)) {
+                cout << " ID inválido.\n";
+                limpiarEntrada();
+                pausar();
+                continue;
+            }
+            cout << "ID de la segunda persona: ";
+            if (!(cin >> idB)) {
+                cout << " ID inválido.\n";
+                limpiarEntrada();
+                pausar();
+                continue;
+            }
+            limpiarEntrada();
+
+            Persona* a = buscar(raiz, idA);
+            Persona* b = buscar(raiz, idB);
+            if (a == NULL || b == NULL) {
+                cout << " No existe una persona con ID " << (a == NULL ? idA : idB) << ".\n";
+            } else if (a == b) {
+                cout << " Es la misma persona.\n";
+            } else {
+                Parentesco p = calcularParentesco(raiz, a, b);
+                cout << "\n " << a->nombre << " " << a->apellido << " es " << p.etiqueta
+                     << " de " << b->nombre << " " << b->apellido << ".\n";
+                cout << " Ancestro común más cercano: " << p.ancestroComun->nombre << " "
+                     << p.ancestroComun->apellido << " (ID:" << p.ancestroComun->id << ")\n";
+                cout << " Generaciones hasta el ancestro común: " << p.generacionesA << " y " << p.generacionesB
+                     << " (grado de consanguinidad " << p.generacionesA + p.generacionesB << ")\n";
+            }
+        }
+        
+        // ----------------------------
+        // Opción 12: Ver ancestros de una persona (sube por los padres)
+        // ----------------------------
+        else if (opcion == 12) {
+            int id;
+            cout << "ID de la persona: ";
+            if (!(cin >> id)) {
+                cout << " ID inválido.\n";
+                limpiarEntrada();
+                pausar();
+                continue;
+            }
+            limpiarEntrada();
+
+            Persona* p = buscar(raiz, id);
+            if (p == NULL) {
+                cout << " No existe una persona con ese ID.\n";
+            } else {
+                vector<Persona*> ancestros = ancestrosDe(p);
+                cout << "\n " << p->nombre << " " << p->apellido << " está a "
+                     << ancestros.size() << " generaciones de la raíz.\n";
+                for (size_t i = 0; i < ancestros.size(); i++)
+                    cout << "  " << setw(3) << right << i + 1 << ". " << ancestros[i]->nombre << " "
+                         << ancestros[i]->apellido << " (ID:" << ancestros[i]->id << ")\n";
+            }
+        }
         
-        // Pausa tras cada operacin
-        if (opcion >= 1 && opcion <= 4) pausar();
+        // Pausa tras cada operación
+        if (opcion >= 1 && opcion <= 12) pausar();
         
-    } while (opcion != 5); // Volver al men principal
+    } while (opcion != 13); // Volver al menú principal
 }
 
 // ------------------------------------------------------
-// Submen de Recorridos del rbol
+// Submenú de Recorridos del Árbol
 // ------------------------------------------------------
+
 void submenuRecorridos(Persona* raiz) {
     int opcion;
     do {
         limpiarPantalla();
-        mostrarEncabezado("SUBMEN - RECORRIDOS DEL RBOL");
+        mostrarEncabezado("SUBMENÚ - RECORRIDOS DEL ÁRBOL");
 
         // Opciones de recorridos
-        cout << "  1. Recorrido Preorden (Raz-Izq-Der)\n";
-        cout << "  2. Recorrido Inorden (Izq-Raz-Der)\n";
-        cout << "  3. Recorrido Postorden (Izq-Der-Raz)\n";
-        cout << "  4. Volver al men principal\n";
-        cout << "\nSeleccione una opcin: ";
+        cout << "  1. Recorrido Preorden (Raíz-Izq-Der)\n";
+        cout << "  2. Recorrido Inorden (Izq-Raíz-Der)\n";
+        cout << "  3. Recorrido Postorden (Izq-Der-Raíz)\n";
+        cout << "  4. Volver al menú principal\n";
+        cout << "\nSeleccione una opción: ";
         
-        // Validar entrada numrica
+        // Validar entrada numérica
         if (!(cin >> opcion)) {
             limpiarEntrada();
             continue;
         }
         limpiarEntrada();
         
-        // El rbol no debe estar vaco
+        // El árbol no debe estar vacío
         if (raiz == NULL && opcion != 4) {
-            cout << " El rbol est vaco.\n";
+            cout << " El árbol está vacío.\n";
             pausar();
             continue;
         }
         
         // ----------------------------
-        // Opcin 1: Recorrido Preorden
+        // Opción 1: Recorrido Preorden
         // ----------------------------
         if (opcion == 1) {
             mostrarEncabezado("RECORRIDO PREORDEN");
@@ -723,7 +919,7 @@ void submenuRecorridos(Persona* raiz) {
         }
 
         // ----------------------------
-        // Opcin 2: Recorrido Inorden
+        // Opción 2: Recorrido Inorden
         // ----------------------------
         else if (opcion == 2) {
             mostrarEncabezado("RECORRIDO INORDEN");
@@ -732,7 +928,7 @@ void submenuRecorridos(Persona* raiz) {
         }
 
         // ----------------------------
-        // Opcin 3: Recorrido Postorden
+        // Opción 3: Recorrido Postorden
         // ----------------------------
         else if (opcion == 3) {
             mostrarEncabezado("RECORRIDO POSTORDEN");
@@ -740,229 +936,1178 @@ void submenuRecorridos(Persona* raiz) {
             cout << "\n";
         }
         
-        // Pausa despus de recorridos
+        // Pausa después de recorridos
         if (opcion >= 1 && opcion <= 3) pausar();
         
-    } while (opcion != 4); // Volver al men principal
+    } while (opcion != 4); // Volver al menú principal
 }
 
-
 // ------------------------------------------------------
-// Men Principal del Programa
+// Submenú de Consultas sobre una imagen de solo lectura
 // ------------------------------------------------------
-int main() {
-    setlocale(LC_CTYPE, "Spanish");  // Configurar idioma para caracteres especiales
-    Persona* raiz = NULL;            // Puntero a la raz del rbol genealgico
+
+void submenuImagen(const ImagenArbol& img) {
     int opcion;
-    
     do {
         limpiarPantalla();
+        mostrarEncabezado("SUBMENÚ - IMAGEN DE SOLO LECTURA");
+
+        // Opciones de consulta sobre la imagen
+        cout << "  1. Buscar persona por ID\n";
+        cout << "  2. Ver hijos de una persona\n";
+        cout << "  3. Recorrido Preorden\n";
+        cout << "  4. Recorrido Inorden\n";
+        cout << "  5. Recorrido Postorden\n";
+        cout << "  6. Ver estadísticas\n";
+        cout << "  7. Cerrar imagen y volver\n";
+        cout << "\nSeleccione una opción: ";
         
-        // Encabezado del sistema
-        cout << "\n+------------------------------------------------+\n";
-        cout << "       SISTEMA DE RBOL GENEALGICO FAMILIAR    \n";
-        cout << "+------------------------------------------------+\n\n";
-        
-        // Men principal  opciones disponibles
-        cout << "  +-------------------------------------+\n";
-        cout << "    1. Insertar personas               \n";
-        cout << "    2. Consultar informacin           \n";
-        cout << "    3. Recorridos del rbol            \n";
-        cout << "    4. Eliminar persona                \n";
-        cout << "    5. Limpiar rbol completo          \n";
-        cout << "    6. Generar rbol ficticio          \n";
-        cout << "    7. Guardar rbol en archivo        \n";
-        cout << "    8. Salir                           \n";
-        cout << "  +-------------------------------------+\n";
-        cout << "\n  Seleccione una opcin: ";
-        
-        // Validar entrada numrica del men
+        // Validar entrada numérica
         if (!(cin >> opcion)) {
             limpiarEntrada();
             continue;
         }
         limpiarEntrada();
         
-        switch (opcion) {
-
-            // ---------------------------------
-            // 1. Submen para insertar personas
-            // ---------------------------------
-            case 1:
-                submenuInsertar(raiz);
-                break;
-                
-            // ---------------------------------
-            // 2. Submen para consultas
-            // ---------------------------------
-            case 2:
-                submenuConsultar(raiz);
-                break;
-                
-            // ---------------------------------
-            // 3. Submen de recorridos del rbol
-            // ---------------------------------
-            case 3:
-                submenuRecorridos(raiz);
-                break;
-                
-            // ---------------------------------
-            // 4. Eliminar una persona especfica
-            // ---------------------------------
-            case 4: {
-                if (!raiz) {
-                    cout << " El rbol est vaco.\n";
-                    pausar();
-                    break;
-                }
-                
-                int id;
-                cout << "ID de la persona a eliminar: ";
-                
-                // Validar ID
-                if (!(cin >> id)) {
-                    cout << " ID invlido.\n";
-                    limpiarEntrada();
-                    pausar();
-                    break;
-                }
+        // ----------------------------
+        // Opciones 1 y 2: consultas por ID
+        // ----------------------------
+        if (opcion == 1 || opcion == 2) {
+            int id;
+            cout << "ID de la persona: ";
+            if (!(cin >> id)) {
+                cout << " ID inválido.\n";
                 limpiarEntrada();
-                
-                // Comprobar que exista
-                if (!buscar(raiz, id)) {
-                    cout << " No existe una persona con ese ID.\n";
-                    pausar();
-                    break;
-                }
-                
-                // No permitir eliminar la raz desde este men
-                if (id == raiz->id) {
-                    cout << " No se puede eliminar la raz. Use opcin 5.\n";
-                    pausar();
-                    break;
-                }
-                
-                // Llamar a la funcin de eliminacin
-                raiz = eliminarPersona(raiz, id);
-                cout << " Persona y sus descendientes eliminados.\n";
                 pausar();
-                break;
+                continue;
+            }
+            limpiarEntrada();
+
+            if (opcion == 2) {
+                mostrarHijosImagen(img, id);
+            } else {
+                uint32_t indice = buscarEnImagen(img, id);
+                if (indice != IMAGEN_NINGUNO) mostrarDetalleImagen(img, indice);
+                else cout << " No se encontró una persona con ese ID.\n";
+            }
+        }
+
+        // ----------------------------
+        // Opciones 3 a 5: recorridos
+        // ----------------------------
+        else if (opcion == 3) {
+            mostrarEncabezado("RECORRIDO PREORDEN");
+            mostrarRecorridoImagen(img, RECORRIDO_PRE);
+        }
+        else if (opcion == 4) {
+            mostrarEncabezado("RECORRIDO INORDEN");
+            mostrarRecorridoImagen(img, RECORRIDO_IN);
+        }
+        else if (opcion == 5) {
+            mostrarEncabezado("RECORRIDO POSTORDEN");
+            mostrarRecorridoImagen(img, RECORRIDO_POST);
+        }
+
+        // ----------------------------
+        // Opción 6: estadísticas
+        // ----------------------------
+        else if (opcion == 6) {
+            mostrarEstadisticasImagen(img);
+        }
+        
+        // Pausa después de cada operación
+        if (opcion >= 1 && opcion <= 6) pausar();
+        
+    } while (opcion != 7); // Volver al submenú de archivos
+}
+
+// ------------------------------------------------------
+// Submenú de Archivos
+// ------------------------------------------------------
+
+// Si ya hay un árbol, pregunta si se puede reemplazar (true: sí o no había)
+bool confirmarReemplazo(Persona* raiz) {
+    if (raiz == NULL) return true;
+    char resp;
+    cout << " Ya existe un árbol. ¿Reemplazarlo? (S/N): ";
+    cin >> resp;
+    limpiarEntrada();
+
+    if (resp != 'S' && resp != 's') {
+        cout << "Operación cancelada.\n";
+        return false;
+    }
+    return true;
+}
+
+// Pide un archivo y lo carga en lugar del árbol actual. El cargador valida
+// el archivo completo antes de tocar el árbol: si falla, el árbol queda
+// como estaba y no se anota nada en el registro de cambios.
+void cargarArchivoDesdeMenu(Persona*& raiz, string extension,
+                            bool (*cargar)(string, Persona*&)) {
+    string nombreArch;
+    cout << "Nombre del archivo (sin extensión): ";
+    getline(cin, nombreArch);
+    nombreArch += extension;
+
+    // Confirmar antes de reemplazar el árbol actual
+    if (!confirmarReemplazo(raiz)) return;
+
+    if (cargar(nombreArch, raiz)) {
+        cout << "\n Árbol cargado: " << contarNodos(raiz) << " personas.\n";
+        anotarCambioMasivo(raiz);
+    } else {
+        cout << "\n No se pudo leer el archivo o su formato es inválido.\n";
+        if (raiz != NULL) cout << " El árbol actual no se modificó.\n";
+    }
+}
+
+void submenuArchivos(Persona*& raiz) {
+    int opcion;
+    do {
+        limpiarPantalla();
+        mostrarEncabezado("SUBMENÚ - ARCHIVOS");
+
+        // Opciones de archivos
+        cout << "  1. Exportar árbol a texto (.txt)\n";
+        cout << "  2. Guardar snapshot binario (.arb)\n";
+        cout << "  3. Cargar snapshot binario (.arb)\n";
+        cout << "  4. Exportar imagen de solo lectura (.ari)\n";
+        cout << "  5. Consultar imagen de solo lectura (.ari)\n";
+        cout << "  6. Importar personas desde CSV/TSV\n";
+        cout << "  7. Guardado incremental (.ars)\n";
+        cout << "  8. Cargar guardado incremental (.ars)\n";
+        cout << "  9. Volver al menú principal\n";
+        cout << "\nSeleccione una opción: ";
+        
+        // Validar entrada numérica
+        if (!(cin >> opcion)) {
+            limpiarEntrada();
+            continue;
+        }
+        limpiarEntrada();
+        
+        // Para guardar el árbol no debe estar vacío
+        if (raiz == NULL && (opcion == 1 || opcion == 2 || opcion == 4 || opcion == 7)) {
+            cout << " El árbol está vacío. No hay datos para guardar.\n";
+            pausar();
+            continue;
+        }
+        
+        // ----------------------------
+        // Opción 1: Exportar a texto
+        // ----------------------------
+        if (opcion == 1) {
+            string nombreArch;
+            cout << "Nombre del archivo (sin extensión): ";
+            getline(cin, nombreArch);
+            nombreArch += ".txt";  // Agregar extensión
+            
+            // Guardar datos del árbol (con avance si el árbol es enorme)
+            bool ok = guardarArbolEnArchivo(raiz, nombreArch,
+                [](size_t nodos, size_t total, size_t bytes) {
+                    if (total < NODOS_POR_AVISO) return;
+                    cout << "\r Exportando: " << nodos << " de " << total << " personas ("
+                         << bytes / (1024 * 1024) << " MB)" << flush;
+                    if (nodos == total) cout << "\n";
+                });
+            if (ok) {
+                cout << "\n Árbol guardado en: " << nombreArch << "\n";
+            } else {
+                cout << "\n Error al crear el archivo.\n";
+            }
+        }
+
+        // ----------------------------
+        // Opción 2: Guardar snapshot binario
+        // ----------------------------
+        else if (opcion == 2) {
+            string nombreArch;
+            cout << "Nombre del archivo (sin extensión): ";
+            getline(cin, nombreArch);
+            nombreArch += ".arb";
+            
+            if (guardarSnapshotBinario(raiz, nombreArch)) {
+                cout << "\n Snapshot guardado en: " << nombreArch << "\n";
+            } else {
+                cout << "\n Error al crear el archivo.\n";
+            }
+        }
+
+        // ----------------------------
+        // Opción 3: Cargar snapshot binario
+        // ----------------------------
+        else if (opcion == 3) {
+            cargarArchivoDesdeMenu(raiz, ".arb", cargarSnapshotBinario);
+        }
+
+        // ----------------------------
+        // Opción 4: Exportar imagen de solo lectura
+        // ----------------------------
+        else if (opcion == 4) {
+            string nombreArch;
+            cout << "Nombre del archivo (sin extensión): ";
+            getline(cin, nombreArch);
+            nombreArch += ".ari";
+            
+            if (guardarImagen(raiz, nombreArch)) {
+                cout << "\n Imagen guardada en: " << nombreArch << "\n";
+            } else {
+                cout << "\n Error al crear el archivo.\n";
+            }
+        }
+
+        // ----------------------------
+        // Opción 5: Consultar imagen (mmap, sin cargar el árbol)
+        // ----------------------------
+        else if (opcion == 5) {
+            string nombreArch;
+            cout << "Nombre del archivo (sin extensión): ";
+            getline(cin, nombreArch);
+            nombreArch += ".ari";
+            
+            ImagenArbol img;
+            if (!abrirImagen(nombreArch, img)) {
+                cout << "\n No se pudo abrir el archivo o su formato es inválido.\n";
+                pausar();
+                continue;
+            }
+            submenuImagen(img);
+            cerrarImagen(img);
+        }
+
+        // ----------------------------
+        // Opción 6: Importación masiva desde CSV/TSV
+        // ----------------------------
+        else if (opcion == 6) {
+            string nombreArch;
+            cout << "Ruta del archivo (con extensión): ";
+            getline(cin, nombreArch);
+            
+            ResultadoImportacion res;
+            if (!importarCSV(nombreArch, raiz, res)) {
+                cout << "\n No se pudo abrir el archivo.\n";
+            } else {
+                cout << "\n Líneas leídas:   " << res.lineas;
+                cout << "\n Importadas:      " << res.importadas;
+                cout << "\n Rechazadas:      " << res.rechazadas << "\n";
+                for (size_t i = 0; i < res.errores.size(); i++)
+                    cout << "   - " << res.errores[i] << "\n";
+                anotarCambioMasivo(raiz);
+            }
+        }
+
+        // ----------------------------
+        // Opción 7: Guardado incremental (solo los segmentos que cambiaron)
+        // ----------------------------
+        else if (opcion == 7) {
+            string nombreArch;
+            cout << "Nombre del archivo (sin extensión): ";
+            getline(cin, nombreArch);
+            nombreArch += ".ars";
+
+            ResultadoGuardado res;
+            if (guardarIncremental(raiz, nombreArch, &res)) {
+                cout << "\n Árbol guardado en: " << nombreArch
+                     << (res.completo ? " (completo)" : " (incremental)") << "\n";
+                cout << " Segmentos escritos: " << res.segmentos << " (" << res.personas
+                     << " personas, " << res.bytes << " bytes)\n";
+            } else {
+                cout << "\n Error al escribir el archivo.\n";
+            }
+        }
+
+        // ----------------------------
+        // Opción 8: Cargar guardado incremental
+        // ----------------------------
+        else if (opcion == 8) {
+            cargarArchivoDesdeMenu(raiz, ".ars", cargarIncremental);
+        }
+        
+        // Pausa después de cada operación
+        if (opcion == 1 || opcion == 2 || opcion == 3 || opcion == 4 || opcion == 6 ||
+            opcion == 7 || opcion == 8) pausar();
+        
+    } while (opcion != 9); // Volver al menú principal
+}
+
+// ------------------------------------------------------
+// Submenú para generar árboles de prueba
+// ------------------------------------------------------
+
+// Pide la forma, el tamaño y la semilla de un árbol sintético
+bool pedirParametrosSinteticos(int& n, FormaArbol& forma, unsigned& semilla) {
+    int opcionForma;
+    cout << "\n  Forma del árbol:\n";
+    cout << "  1. Completo\n";
+    cout << "  2. Aleatorio\n";
+    cout << "  3. Cadena por la izquierda (degenerado)\n";
+    cout << "  4. Cadena por la derecha (degenerado)\n";
+    cout << "  5. Genealogía realista\n";
+    cout << "Forma: ";
+    if (!(cin >> opcionForma) || opcionForma < 1 || opcionForma > 5) {
+        cout << " Forma inválida.\n";
+        limpiarEntrada();
+        return false;
+    }
+    cout << "Cantidad de personas: ";
+    if (!(cin >> n) || n <= 0) {
+        cout << " Cantidad inválida.\n";
+        limpiarEntrada();
+        return false;
+    }
+    cout << "Semilla: ";
+    if (!(cin >> semilla)) {
+        cout << " Semilla inválida.\n";
+        limpiarEntrada();
+        return false;
+    }
+    limpiarEntrada();
+
+    FormaArbol formas[] = { FORMA_COMPLETO, FORMA_ALEATORIO, FORMA_CADENA_IZQ,
+                            FORMA_CADENA_DER, FORMA_GENEALOGIA };
+    forma = formas[opcionForma - 1];
+    return true;
+}
+
+void submenuGenerar(Persona*& raiz) {
+    int opcion;
+    do {
+        limpiarPantalla();
+        mostrarEncabezado("SUBMENÚ - GENERAR ÁRBOLES");
+
+        // Opciones de generación
+        cout << "  1. Familia González (10 personas)\n";
+        cout << "  2. Árbol sintético en memoria\n";
+        cout << "  3. Árbol sintético directo a archivo CSV\n";
+        cout << "  4. Volver al menú principal\n";
+        cout << "\nSeleccione una opción: ";
+        
+        // Validar entrada numérica
+        if (!(cin >> opcion)) {
+            limpiarEntrada();
+            continue;
+        }
+        limpiarEntrada();
+        
+        // Las opciones 1 y 2 reemplazan el árbol actual: se borra recién
+        // cuando la generación va a ocurrir (datos pedidos y confirmada)
+        
+        // ----------------------------
+        // Opción 1: Familia ficticia predefinida
+        // ----------------------------
+        if (opcion == 1) {
+            if (!confirmarReemplazo(raiz)) {
+                pausar();
+                continue;
+            }
+            limpiarArbolCompleto(raiz);
+            raiz = generarArbolFicticio();
+            tipoArbol = ARBOL_GENEALOGICO;
+            cout << "\n Árbol genealógico ficticio generado!\n";
+            
+            // Información del árbol creado
+            cout << "\n  Familia González - 4 generaciones:\n";
+            cout << "  • 1 Patriarca (Carlos - 75 años)\n";
+            cout << "  • 2 Hijos adultos\n";
+            cout << "  • 4 Nietos jóvenes\n";
+            cout << "  • 3 Bisnietos pequeños\n";
+            cout << "  ----------------------------\n";
+            cout << "  Total: 10 personas\n";
+            anotarCambioMasivo(raiz);
+        }
+
+        // ----------------------------
+        // Opción 2: Árbol sintético en memoria
+        // ----------------------------
+        else if (opcion == 2) {
+            int n;
+            FormaArbol forma;
+            unsigned semilla;
+            if (pedirParametrosSinteticos(n, forma, semilla) && confirmarReemplazo(raiz)) {
+                limpiarArbolCompleto(raiz);
+                raiz = generarArbolSintetico(n, forma, semilla);
+                // Una cadena derecha con IDs crecientes respeta el orden ABB
+                tipoArbol = (forma == FORMA_CADENA_DER) ? ARBOL_ABB : ARBOL_GENEALOGICO;
+                cout << "\n Árbol generado: " << contarNodos(raiz) << " personas, altura "
+                     << alturaNodo(raiz) << ".\n";
+                anotarCambioMasivo(raiz);
+            }
+        }
+
+        // ----------------------------
+        // Opción 3: Árbol sintético directo a CSV
+        // ----------------------------
+        else if (opcion == 3) {
+            int n;
+            FormaArbol forma;
+            unsigned semilla;
+            if (pedirParametrosSinteticos(n, forma, semilla)) {
+                string nombreArch;
+                cout << "Nombre del archivo (sin extensión): ";
+                getline(cin, nombreArch);
+                nombreArch += ".csv";
+                
+                if (generarCSVSintetico(nombreArch, n, forma, semilla)) {
+                    cout << "\n Archivo generado: " << nombreArch << "\n";
+                    cout << " Puede cargarse con Archivos > Importar personas desde CSV/TSV.\n";
+                } else {
+                    cout << "\n Error al crear el archivo.\n";
+                }
+            }
+        }
+        
+        // Pausa después de cada operación
+        if (opcion >= 1 && opcion <= 3) pausar();
+        
+    } while (opcion != 4); // Volver al menú principal
+}
+
+// ------------------------------------------------------
+// Modo por lotes (sin menú)
+// ------------------------------------------------------
+//
+// Lee comandos de un archivo o de la entrada estándar, uno por línea, y
+// escribe una línea de resultado por comando. No limpia la pantalla ni hace
+// pausas, así sirve para scripts, pruebas y cargas grandes.
+//
+//   ROOT      <datos>                 Crea la raíz del árbol genealógico
+//   CHILD     <idPadre> <I|D> <datos> Agrega un hijo izquierdo o derecho
+//   INSERT    <datos>                 Inserta con reglas de ABB
+//   INSERTAVL <datos>                 Inserta en un AVL (rebalancea)
+//   FIND      <id>                    Muestra los datos de una persona
+//   FINDBY    <campo> <valor>         Busca por APELLIDO, OCUPACION o GENERO
+//   FINDBY    EDAD <desde> <hasta>    Busca por rango de edad
+//   NAME      <k> <texto>             Hasta k personas cuyo nombre empieza así
+//   FUZZY     <k> <texto>             Hasta k personas con nombre parecido
+//   ANCESTORS <id>                    Ancestros, del padre a la raíz
+//   KIN       <idA> <idB>             Ancestro común y qué es A de B
+//   DELETE    <id>                    Elimina a la persona (y descendientes)
+//   STATS                             Estadísticas del árbol
+//   SAVE      <archivo>               .arb snapshot, .ari imagen, .ars incremental,
+//                                     otro: texto (.gz: comprimido con gzip)
+//   LOAD      <archivo.arb|.ars>      Reemplaza el árbol por un snapshot o un .ars
+//   IMPORT    <archivo.csv>           Importa personas desde CSV/TSV
+//   CLEAR                             Elimina el árbol completo
+//   SNAPSHOT  [descripción]           Guarda una versión del árbol (O(1))
+//   VERSIONS                          Lista las versiones guardadas
+//   ROLLBACK  <número>                Vuelve a una versión guardada
+//
+// <datos> = id nombre apellido edad fecha ocupacion genero. Los valores con
+// espacios van entre comillas dobles. Las líneas vacías y las que empiezan
+// con '#' se ignoran. Cada resultado empieza con "OK" o "ERROR <línea>:".
+
+// Versiones del modo por lotes. 'actual' es una copia persistente del árbol
+// que, desde la primera instantánea, se actualiza en O(profundidad) con cada
+// cambio, así SNAPSHOT no copia nada. Los cambios que no se pueden reflejar
+// con copia de caminos (rotaciones AVL, cargas de archivos) la dejan
+// desactualizada y el siguiente SNAPSHOT vuelve a copiar el árbol.
+struct VersionesLote {
+    HistorialVersiones historial;
+    Version actual;
+    bool alDia;
+};
+
+// Cambia la versión actual por otra (ya retenida)
+void reemplazarVersionActual(VersionesLote& v, Version nueva) {
+    soltarVersion(v.actual);
+    v.actual = nueva;
+}
+
+// Separa una línea en palabras; "entre comillas" forma una sola palabra
+vector<string> separarComando(const string& linea) {
+    vector<string> palabras;
+    size_t i = 0, n = linea.size();
+    while (i < n) {
+        while (i < n && (linea[i] == ' ' || linea[i] == '\t' || linea[i] == '\r')) i++;
+        if (i >= n) break;
+
+        string palabra;
+        if (linea[i] == '"') {
+            size_t cierre = linea.find('"', i + 1);
+            if (cierre == string::npos) cierre = n;
+            palabra = linea.substr(i + 1, cierre - i - 1);
+            i = cierre + 1;
+        } else {
+            size_t fin = i;
+            while (fin < n && linea[fin] != ' ' && linea[fin] != '\t' && linea[fin] != '\r') fin++;
+            palabra = linea.substr(i, fin - i);
+            i = fin;
+        }
+        palabras.push_back(palabra);
+    }
+    return palabras;
+}
+
+// Convierte una palabra completa a entero (false si sobra algo)
+bool leerEnteroLote(const string& texto, int& valor) {
+    if (texto.empty()) return false;
+    char* fin;
+    long v = strtol(texto.c_str(), &fin, 10);
+    if (*fin != '\0' || v < INT_MIN || v > INT_MAX) return false;
+    valor = (int)v;
+    return true;
+}
+
+// Escribe un valor para la salida; si tiene espacios lo pone entre comillas
+void escribirValorLote(string& salida, const string& valor) {
+    if (valor.empty() || valor.find_first_of(" \t") != string::npos)
+        salida += "\"" + valor + "\"";
+    else
+        salida += valor;
+}
+
+// Crea una persona con los 7 campos que empiezan en palabras[desde].
+// Devuelve NULL y deja el motivo en error si algún campo no es válido.
+Persona* personaDeComando(Persona* raiz, const vector<string>& palabras, size_t desde,
+                          string& error) {
+    if (palabras.size() != desde + 7) {
+        error = "se esperaban 7 datos: id nombre apellido edad fecha ocupacion genero";
+        return NULL;
+    }
+    int id, edad;
+    if (!leerEnteroLote(palabras[desde], id)) {
+        error = "ID inválido";
+        return NULL;
+    }
+    if (buscar(raiz, id)) {
+        error = mensajeEstado(ESTADO_ID_DUPLICADO);
+        return NULL;
+    }
+    if (!leerEnteroLote(palabras[desde + 3], edad) || !edadValida(edad)) {
+        error = "edad inválida (0 a 120)";
+        return NULL;
+    }
+    if (!generoValido(palabras[desde + 6])) {
+        error = "género inválido (Masculino/Femenino)";
+        return NULL;
+    }
+    return crearPersona(id, palabras[desde + 1], palabras[desde + 2], edad,
+                        palabras[desde + 4], palabras[desde + 5], palabras[desde + 6]);
+}
+
+// Indica si el nombre de archivo termina con la extensión dada
+bool tieneExtension(const string& nombre, const string& extension) {
+    return nombre.size() >= extension.size() &&
+           nombre.compare(nombre.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+// Ejecuta un comando ya separado en palabras. Deja el resultado (sin "OK"
+// ni "ERROR") en respuesta y devuelve true si el comando tuvo éxito.
+bool ejecutarComando(const vector<string>& palabras, Persona*& raiz, VersionesLote& versiones,
+                     string& respuesta) {
+    string comando = palabras[0];
+    for (size_t i = 0; i < comando.size(); i++)
+        comando[i] = (char)toupper((unsigned char)comando[i]);
+
+    // ----------------------------
+    // Inserciones
+    // ----------------------------
+    if (comando == "ROOT") {
+        if (raiz != NULL) {
+            respuesta = "el árbol ya tiene raíz";
+            return false;
+        }
+        Persona* nueva = personaDeComando(raiz, palabras, 1, respuesta);
+        if (!nueva) return false;
+        raiz = nueva;
+        tipoArbol = ARBOL_GENEALOGICO;
+        anotarAlta(REGISTRO_RAIZ, raiz);
+        if (versiones.alDia) reemplazarVersionActual(versiones, versionDesdeArbol(raiz));
+        return true;
+    }
+
+    if (comando == "CHILD") {
+        if (raiz == NULL) {
+            respuesta = "el árbol está vacío";
+            return false;
+        }
+        int idPadre;
+        if (palabras.size() < 3 || !leerEnteroLote(palabras[1], idPadre)) {
+            respuesta = "uso: CHILD idPadre I|D datos";
+            return false;
+        }
+        Persona* nuevo = personaDeComando(raiz, palabras, 3, respuesta);
+        if (!nuevo) return false;
+
+        char lado = (char)toupper((unsigned char)palabras[2][0]);
+        if (palabras[2].size() != 1) lado = '?';
+        string rutaPadre;
+        if (versiones.alDia) rutaPadre = rutaDePersona(buscar(raiz, idPadre));
+
+        EstadoArbol estado = insertarHijo(raiz, idPadre, nuevo, lado);
+        if (estado != ESTADO_OK && estado != ESTADO_REEMPLAZADO) {
+            liberarPersona(nuevo);
+            respuesta = mensajeEstado(estado);
+            return false;
+        }
+        tipoArbol = ARBOL_GENEALOGICO;  // Ya no respeta el orden ABB
+        anotarAlta(REGISTRO_HIJO, nuevo, idPadre, lado);
+        if (versiones.alDia)
+            reemplazarVersionActual(versiones, insertarHijoEnRuta(versiones.actual, rutaPadre,
+                                                                  datosDePersona(nuevo), lado));
+        if (estado == ESTADO_REEMPLAZADO) respuesta = "REEMPLAZADO";
+        return true;
+    }
+
+    if (comando == "INSERT" || comando == "INSERTAVL") {
+        bool avl = (comando == "INSERTAVL");
+        if (avl && raiz != NULL && tipoArbol != ARBOL_AVL) {
+            respuesta = "el árbol actual no es un AVL";
+            return false;
+        }
+        Persona* nueva = personaDeComando(raiz, palabras, 1, respuesta);
+        if (!nueva) return false;
+
+        if (avl) {
+            raiz = insertarAVL(raiz, nueva);
+            tipoArbol = ARBOL_AVL;
+            anotarAlta(REGISTRO_AVL, nueva);
+            versiones.alDia = false;   // Las rotaciones cambian más que un camino
+        } else {
+            // Un AVL que recibe una inserción sin balancear pasa a ser ABB
+            if (raiz == NULL || tipoArbol == ARBOL_AVL)
+                tipoArbol = ARBOL_ABB;
+            raiz = insertarABB(raiz, nueva);
+            anotarAlta(REGISTRO_ABB, nueva);
+            if (versiones.alDia)
+                reemplazarVersionActual(versiones, insertarABBPersistente(versiones.actual,
+                                                                          datosDePersona(nueva)));
+        }
+        return true;
+    }
+
+    // ----------------------------
+    // Consultas y eliminación
+    // ----------------------------
+    if (comando == "FINDBY") {
+        // FINDBY APELLIDO|OCUPACION|GENERO valor  o  FINDBY EDAD desde hasta
+        string campo = palabras.size() > 1 ? palabras[1] : "";
+        for (size_t i = 0; i < campo.size(); i++)   // Igual que el comando: sin importar mayúsculas
+            campo[i] = (char)toupper((unsigned char)campo[i]);
+        vector<Persona*> encontradas;
+        int desde, hasta;
+        if (campo == "EDAD" && palabras.size() == 4 &&
+            leerEnteroLote(palabras[2], desde) && leerEnteroLote(palabras[3], hasta)) {
+            encontradas = buscarPorEdad(desde, hasta);
+        } else if (palabras.size() == 3 && campo == "APELLIDO") {
+            encontradas = buscarPorApellido(palabras[2]);
+        } else if (palabras.size() == 3 && campo == "OCUPACION") {
+            encontradas = buscarPorOcupacion(palabras[2]);
+        } else if (palabras.size() == 3 && campo == "GENERO") {
+            encontradas = buscarPorGenero(palabras[2]);
+        } else {
+            respuesta = "uso: FINDBY APELLIDO|OCUPACION|GENERO valor o FINDBY EDAD desde hasta";
+            return false;
+        }
+
+        // Cantidad y los IDs en orden
+        sort(encontradas.begin(), encontradas.end(), compararPorID);
+        respuesta = to_string(encontradas.size());
+        for (size_t i = 0; i < encontradas.size(); i++)
+            respuesta += " " + to_string(encontradas[i]->id);
+        return true;
+    }
+
+    if (comando == "NAME" || comando == "FUZZY") {
+        // NAME k texto / FUZZY k texto: hasta k personas, de la más cercana a
+        // la más lejana (el texto puede ocupar varias palabras)
+        int k;
+        if (palabras.size() < 3 || !leerEnteroLote(palabras[1], k) || k <= 0) {
+            respuesta = "uso: " + comando + " k texto";
+            return false;
+        }
+        string texto = palabras[2];
+        for (size_t i = 3; i < palabras.size(); i++) texto += " " + palabras[i];
+
+        vector<Persona*> encontradas;
+        if (comando == "NAME") {
+            encontradas = buscarNombresPorPrefijo(texto, k);
+        } else {
+            vector<CoincidenciaNombre> parecidas = buscarNombresParecidos(texto, k);
+            for (size_t i = 0; i < parecidas.size(); i++) encontradas.push_back(parecidas[i].persona);
+        }
+        respuesta = to_string(encontradas.size());
+        for (size_t i = 0; i < encontradas.size(); i++)
+            respuesta += " " + to_string(encontradas[i]->id);
+        return true;
+    }
+
+    if (comando == "ANCESTORS") {
+        // ANCESTORS id: profundidad y los IDs del padre hasta la raíz
+        int id;
+        if (palabras.size() != 2 || !leerEnteroLote(palabras[1], id)) {
+            respuesta = "uso: ANCESTORS id";
+            return false;
+        }
+        Persona* p = buscar(raiz, id);
+        if (!p) {
+            respuesta = mensajeEstado(ESTADO_NO_EXISTE);
+            return false;
+        }
+        vector<Persona*> ancestros = ancestrosDe(p);
+        respuesta = to_string(ancestros.size());
+        for (size_t i = 0; i < ancestros.size(); i++)
+            respuesta += " " + to_string(ancestros[i]->id);
+        return true;
+    }
+
+    if (comando == "KIN") {
+        // KIN idA idB: ancestro común, generaciones de cada uno y qué es A de B
+        int idA, idB;
+        if (palabras.size() != 3 || !leerEnteroLote(palabras[1], idA) || !leerEnteroLote(palabras[2], idB)) {
+            respuesta = "uso: KIN idA idB";
+            return false;
+        }
+        Persona* a = buscar(raiz, idA);
+        Persona* b = buscar(raiz, idB);
+        if (a == NULL || b == NULL) {
+            respuesta = mensajeEstado(ESTADO_NO_EXISTE);
+            return false;
+        }
+        Parentesco p = calcularParentesco(raiz, a, b);
+        respuesta = to_string(p.ancestroComun->id) + " " + to_string(p.generacionesA) + " " +
+                    to_string(p.generacionesB) + " ";
+        escribirValorLote(respuesta, p.etiqueta);
+        return true;
+    }
+
+    if (comando == "FIND" || comando == "DELETE") {
+        int id;
+        if (palabras.size() != 2 || !leerEnteroLote(palabras[1], id)) {
+            respuesta = "uso: " + comando + " id";
+            return false;
+        }
+        Persona* p = buscar(raiz, id);
+        if (!p) {
+            respuesta = mensajeEstado(ESTADO_NO_EXISTE);
+            return false;
+        }
+
+        if (comando == "FIND") {
+            respuesta = to_string(p->id) + " ";
+            escribirValorLote(respuesta, p->nombre);          respuesta += " ";
+            escribirValorLote(respuesta, p->apellido);        respuesta += " ";
+            respuesta += to_string(p->edad) + " ";
+            escribirValorLote(respuesta, p->fechaNacimiento); respuesta += " ";
+            escribirValorLote(respuesta, p->ocupacion);       respuesta += " ";
+            escribirValorLote(respuesta, p->genero);
+            return true;
+        }
+
+        // DELETE: en un AVL sale solo esa persona; si no, todo su subárbol
+        int eliminadas = 1;
+        if (tipoArbol == ARBOL_AVL) {
+            raiz = eliminarAVL(raiz, id);
+            anotarBaja(REGISTRO_ELIMINAR_AVL, id);
+            versiones.alDia = false;
+        } else {
+            string ruta = rutaDePersona(p);
+            raiz = eliminarPersona(raiz, id, &eliminadas);
+            anotarBaja(REGISTRO_ELIMINAR, id);
+            if (versiones.alDia)
+                reemplazarVersionActual(versiones, eliminarEnRuta(versiones.actual, ruta));
+        }
+        respuesta = to_string(eliminadas);
+        return true;
+    }
+
+    if (comando == "STATS") {
+        // Los agregados de la raíz ya tienen todo: O(1)
+        if (raiz == NULL) {
+            respuesta = "personas=0";
+            return true;
+        }
+        char texto[160];
+        snprintf(texto, sizeof(texto),
+                 "personas=%d altura=%d edad_promedio=%.1f masculino=%d femenino=%d otro=%d",
+                 raiz->tamano, raiz->altura, (double)raiz->sumaEdades / raiz->tamano,
+                 raiz->generos[0], raiz->generos[1], raiz->generos[2]);
+        respuesta = texto;
+        return true;
+    }
+
+    if (comando == "CLEAR") {
+        limpiarArbolCompleto(raiz);
+        tipoArbol = ARBOL_GENEALOGICO;
+        anotarBaja(REGISTRO_LIMPIAR, 0);
+        reemplazarVersionActual(versiones, NULL);
+        versiones.alDia = true;
+        return true;
+    }
+
+    // ----------------------------
+    // Versiones
+    // ----------------------------
+    if (comando == "SNAPSHOT") {
+        if (!versiones.alDia) {
+            reemplazarVersionActual(versiones, versionDesdeArbol(raiz));
+            versiones.alDia = true;
+        }
+        string descripcion;
+        for (size_t i = 1; i < palabras.size(); i++)
+            descripcion += (i > 1 ? " " : "") + palabras[i];
+        respuesta = to_string(guardarVersion(versiones.historial, versiones.actual,
+                                             tipoArbol, descripcion));
+        return true;
+    }
+
+    if (comando == "VERSIONS") {
+        // número:personas de cada versión guardada
+        const vector<VersionGuardada>& lista = versiones.historial.versiones;
+        respuesta = to_string(lista.size());
+        for (size_t i = 0; i < lista.size(); i++)
+            respuesta += " " + to_string(i) + ":" +
+                         to_string(lista[i].raiz ? lista[i].raiz->tamano : 0);
+        return true;
+    }
+
+    if (comando == "ROLLBACK") {
+        int numero;
+        const vector<VersionGuardada>& lista = versiones.historial.versiones;
+        if (palabras.size() != 2 || !leerEnteroLote(palabras[1], numero) ||
+            numero < 0 || numero >= (int)lista.size()) {
+            respuesta = "uso: ROLLBACK número (0 a " + to_string((int)lista.size() - 1) + ")";
+            return false;
+        }
+        limpiarArbolCompleto(raiz);
+        raiz = arbolDesdeVersion(lista[numero].raiz);
+        tipoArbol = lista[numero].tipo;
+        anotarCambioMasivo(raiz);
+        reemplazarVersionActual(versiones, retenerVersion(lista[numero].raiz));
+        versiones.alDia = true;
+        respuesta = to_string(raiz ? raiz->tamano : 0);
+        return true;
+    }
+
+    // ----------------------------
+    // Archivos
+    // ----------------------------
+    if (comando == "SAVE" || comando == "LOAD" || comando == "IMPORT") {
+        if (palabras.size() != 2) {
+            respuesta = "uso: " + comando + " archivo";
+            return false;
+        }
+        if (comando != "SAVE") versiones.alDia = false;   // El árbol cambia entero
+        const string& nombre = palabras[1];
+
+        if (comando == "SAVE") {
+            if (raiz == NULL) {
+                respuesta = "el árbol está vacío";
+                return false;
+            }
+            bool ok;
+            if (tieneExtension(nombre, ".arb"))      ok = guardarSnapshotBinario(raiz, nombre);
+            else if (tieneExtension(nombre, ".ari")) ok = guardarImagen(raiz, nombre);
+            else if (tieneExtension(nombre, ".ars")) ok = guardarIncremental(raiz, nombre);
+            else                                      ok = guardarArbolEnArchivo(raiz, nombre);
+            if (!ok) respuesta = "no se pudo escribir " + nombre;
+            return ok;
+        }
+
+        if (comando == "LOAD") {
+            // Igual que en el menú: el árbol actual se reemplaza solo si el
+            // archivo se pudo leer completo; si no, queda como estaba
+            bool ok = tieneExtension(nombre, ".ars") ? cargarIncremental(nombre, raiz)
+                                                     : cargarSnapshotBinario(nombre, raiz);
+            if (!ok) {
+                respuesta = "no se pudo leer " + nombre;
+                return false;
+            }
+            anotarCambioMasivo(raiz);
+            respuesta = to_string(raiz ? raiz->tamano : 0);
+            return true;
+        }
+
+        // IMPORT
+        ResultadoImportacion res;
+        if (!importarCSV(nombre, raiz, res)) {
+            respuesta = "no se pudo leer " + nombre;
+            return false;
+        }
+        anotarCambioMasivo(raiz);
+        respuesta = "importadas=" + to_string(res.importadas) +
+                    " rechazadas=" + to_string(res.rechazadas);
+        return true;
+    }
+
+    respuesta = "comando desconocido: " + palabras[0];
+    return false;
+}
+
+// Ejecuta todos los comandos de la entrada y devuelve la cantidad de errores.
+// Las respuestas se acumulan en un búfer y se vuelcan en bloques grandes.
+int ejecutarLote(istream& entrada, ostream& salida, Persona*& raiz) {
+    string linea, respuesta, bufer;
+    int numeroLinea = 0, errores = 0;
+
+    // Sin instantáneas no hay copia persistente que mantener
+    VersionesLote versiones;
+    versiones.actual = NULL;
+    versiones.alDia = false;
+
+    while (getline(entrada, linea)) {
+        numeroLinea++;
+        vector<string> palabras = separarComando(linea);
+        if (palabras.empty() || palabras[0][0] == '#') continue;
+
+        respuesta.clear();
+        if (ejecutarComando(palabras, raiz, versiones, respuesta)) {
+            bufer += "OK";
+            if (!respuesta.empty()) bufer += " " + respuesta;
+        } else {
+            bufer += "ERROR " + to_string(numeroLinea) + ": " + respuesta;
+            errores++;
+        }
+        bufer += '\n';
+        if (registroActivo) checkpointSiCorresponde(*registroActivo, raiz);
+
+        if (bufer.size() >= (1 << 16)) {
+            salida << bufer;
+            bufer.clear();
+        }
+    }
+    salida << bufer;
+    salida.flush();
+
+    vaciarHistorial(versiones.historial);
+    soltarVersion(versiones.actual);
+    return errores;
+}
+
+// ------------------------------------------------------
+// Menú Principal del Programa
+// ------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    setlocale(LC_CTYPE, "Spanish");  // Configurar idioma para caracteres especiales
+    Persona* raiz = NULL;            // Puntero a la raíz del árbol genealógico
+    int opcion;
+
+    // Opciones: "--registro base" y "--lote [archivo]" (sin archivo o con
+    // "-" el modo por lotes lee de stdin)
+    string baseRegistro, archivoLote = "-";
+    bool lote = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--registro" && i + 1 < argc) {
+            baseRegistro = argv[++i];
+        } else if (arg == "--lote") {
+            lote = true;
+            if (i + 1 < argc && string(argv[i + 1]) != "--registro") archivoLote = argv[++i];
+        }
+    }
+
+    // Con registro: recuperar el árbol (checkpoint + cambios) antes de empezar
+    RegistroCambios registro;
+    if (!baseRegistro.empty()) {
+        ResultadoRecuperacion rec;
+        if (!abrirRegistro(registro, baseRegistro, raiz, rec)) {
+            cerr << "No se pudo abrir el registro " << baseRegistro << ".wal\n";
+            return 2;
+        }
+        registroActivo = &registro;
+        cerr << "Registro " << baseRegistro << ": " << contarNodos(raiz) << " personas recuperadas ("
+             << (rec.habiaCheckpoint ? "checkpoint + " : "") << rec.aplicados << " cambios"
+             << (rec.colaDescartada ? ", final incompleto descartado" : "") << ")\n";
+    }
+
+    // Modo por lotes: sin menú, con commit en grupo del registro
+    if (lote) {
+        ios::sync_with_stdio(false);
+        int errores;
+        if (archivoLote == "-") {
+            errores = ejecutarLote(cin, cout, raiz);
+        } else {
+            ifstream archivo(archivoLote.c_str());
+            if (!archivo) {
+                cerr << "No se pudo abrir " << archivoLote << "\n";
+                return 2;
             }
+            errores = ejecutarLote(archivo, cout, raiz);
+        }
+        if (registroActivo) cerrarRegistro(registro);
+        limpiarArbolCompleto(raiz);
+        return errores > 0 ? 1 : 0;
+    }
+
+    // En el menú cada cambio se confirma en disco antes de mostrar el resultado
+    if (registroActivo) registro.registrosPorLote = 1;
+    
+    do {
+        if (registroActivo) checkpointSiCorresponde(registro, raiz);
+        limpiarPantalla();
+        
+        // Encabezado del sistema
+        cout << "\n+------------------------------------------------+\n";
+        cout << "¦       SISTEMA DE ÁRBOL GENEALÓGICO FAMILIAR    ¦\n";
+        cout << "+------------------------------------------------+\n\n";
+        
+        // Menú principal – opciones disponibles
+        cout << "  +-------------------------------------+\n";
+        cout << "  ¦  1. Insertar personas               ¦\n";
+        cout << "  ¦  2. Consultar información           ¦\n";
+        cout << "  ¦  3. Recorridos del árbol            ¦\n";
+        cout << "  ¦  4. Eliminar persona                ¦\n";
+        cout << "  ¦  5. Limpiar árbol completo          ¦\n";
+        cout << "  ¦  6. Generar árboles de prueba       ¦\n";
+        cout << "  ¦  7. Archivos (guardar/cargar)       ¦\n";
+        cout << "  ¦  8. Salir                           ¦\n";
+        cout << "  +-------------------------------------+\n";
+        cout << "\n  Seleccione una opción: ";
+        
+        // Validar entrada numérica del menú
+        if (!(cin >> opcion)) {
+            limpiarEntrada();
+            continue;
+        }
+        limpiarEntrada();
+        
+        switch (opcion) {
+
+            // ---------------------------------
+            // 1. Submenú para insertar personas
+            // ---------------------------------
+            case 1:
+                submenuInsertar(raiz);
+                break;
                 
             // ---------------------------------
-            // 5. Eliminar todo el rbol completo
+            // 2. Submenú para consultas
             // ---------------------------------
-            case 5: {
+            case 2:
+                submenuConsultar(raiz);
+                break;
+                
+            // ---------------------------------
+            // 3. Submenú de recorridos del árbol
+            // ---------------------------------
+            case 3:
+                submenuRecorridos(raiz);
+                break;
+                
+            // ---------------------------------
+            // 4. Eliminar una persona específica
+            // ---------------------------------
+            case 4: {
                 if (!raiz) {
-                    cout << " El rbol ya est vaco.\n";
+                    cout << " El árbol está vacío.\n";
                     pausar();
                     break;
                 }
                 
-                char conf;
-                cout << " Est seguro de eliminar TODO el rbol? (S/N): ";
-                cin >> conf;
-                limpiarEntrada();
+                int id;
+                cout << "ID de la persona a eliminar: ";
                 
-                if (conf == 'S' || conf == 's') {
-                    eliminarArbol(raiz);
-                    raiz = NULL;
-                    cout << " rbol eliminado completamente.\n";
-                } else {
-                    cout << "Operacin cancelada.\n";
+                // Validar ID
+                if (!(cin >> id)) {
+                    cout << " ID inválido.\n";
+                    limpiarEntrada();
+                    pausar();
+                    break;
                 }
-                pausar();
-                break;
-            }
+                limpiarEntrada();
                 
-            // ---------------------------------
-            // 6. Generar automticamente un rbol ficticio
-            // ---------------------------------
-            case 6: {
-                // Verificar si ya existe un rbol
-                if (raiz != NULL) {
-                    char resp;
-                    cout << " Ya existe un rbol. Reemplazarlo? (S/N): ";
-                    cin >> resp;
-                    limpiarEntrada();
-                    
-                    if (resp == 'S' || resp == 's') {
-                        eliminarArbol(raiz);
-                        raiz = NULL;
-                    } else {
-                        cout << "Operacin cancelada.\n";
+                // En un AVL se elimina solo esa persona y se rebalancea
+                // (basta con comparar IDs para saber si existe)
+                if (tipoArbol == ARBOL_AVL) {
+                    if (!buscarABB(raiz, id)) {
+                        cout << " No existe una persona con ese ID.\n";
                         pausar();
                         break;
                     }
+                    raiz = eliminarAVL(raiz, id);
+                    anotarBaja(REGISTRO_ELIMINAR_AVL, id);
+                    cout << " Persona eliminada y árbol rebalanceado.\n";
+                    pausar();
+                    break;
                 }
                 
-                // Crear rbol ficticio
-                raiz = generarArbolFicticio();
-                cout << "\n rbol genealgico ficticio generado!\n";
-                
-                // Informacin del rbol creado
-                cout << "\n  Familia Gonzlez - 4 generaciones:\n";
-                cout << "   1 Patriarca (Carlos - 75 aos)\n";
-                cout << "   2 Hijos adultos\n";
-                cout << "   4 Nietos jvenes\n";
-                cout << "   3 Bisnietos pequeos\n";
-                cout << "  ----------------------------\n";
-                cout << "  Total: 10 personas\n";
+                // No permitir eliminar la raíz desde este menú
+                if (id == raiz->id) {
+                    cout << " No se puede eliminar la raíz. Use opción 5.\n";
+                    pausar();
+                    break;
+                }
                 
+                // La eliminación ubica a la persona una sola vez: si no
+                // liberó a nadie es que el ID no existe
+                int liberadas;
+                raiz = eliminarPersona(raiz, id, &liberadas);
+                if (liberadas == 0) {
+                    cout << " No existe una persona con ese ID.\n";
+                    pausar();
+                    break;
+                }
+                anotarBaja(REGISTRO_ELIMINAR, id);
+                cout << " Persona y sus descendientes eliminados (" << liberadas << " en total).\n";
                 pausar();
                 break;
             }
                 
             // ---------------------------------
-            // 7. Guardar rbol en archivo de texto
+            // 5. Eliminar todo el árbol completo
             // ---------------------------------
-            case 7: {
+            case 5: {
                 if (!raiz) {
-                    cout << " El rbol est vaco. No hay datos para guardar.\n";
+                    cout << " El árbol ya está vacío.\n";
                     pausar();
                     break;
                 }
                 
-                string nombreArch;
-                cout << "Nombre del archivo (sin extensin): ";
-                getline(cin, nombreArch);
-                nombreArch += ".txt";  // Agregar extensin
+                char conf;
+                cout << " ¿Está seguro de eliminar TODO el árbol? (S/N): ";
+                cin >> conf;
+                limpiarEntrada();
                 
-                // Guardar datos del rbol
-                if (guardarArbolEnArchivo(raiz, nombreArch)) {
-                    cout << "\n rbol guardado en: " << nombreArch << "\n";
+                if (conf == 'S' || conf == 's') {
+                    limpiarArbolCompleto(raiz);
+                    anotarBaja(REGISTRO_LIMPIAR, 0);
+                    cout << " Árbol eliminado completamente.\n";
                 } else {
-                    cout << "\n Error al crear el archivo.\n";
+                    cout << "Operación cancelada.\n";
                 }
                 pausar();
                 break;
             }
                 
+            // ---------------------------------
+            // 6. Submenú para generar árboles de prueba
+            // ---------------------------------
+            case 6:
+                submenuGenerar(raiz);
+                break;
+                
+            // ---------------------------------
+            // 7. Submenú de archivos (texto y binario)
+            // ---------------------------------
+            case 7:
+                submenuArchivos(raiz);
+                break;
+                
             // ---------------------------------
             // 8. Salir del sistema
             // ---------------------------------
             case 8:
                 cout << "\n+------------------------------------------------+\n";
-                cout << "     Gracias por usar el sistema!             \n";
-                cout << "     Hasta pronto...                           \n";
+                cout << "¦     ¡Gracias por usar el sistema!             ¦\n";
+                cout << "¦     Hasta pronto...                           ¦\n";
                 cout << "+------------------------------------------------+\n\n";
                 break;
                 
             // ---------------------------------
-            // Opcin invlida
+            // Opción inválida
             // ---------------------------------
             default:
-                cout << " Opcin invlida. Intente nuevamente.\n";
+                cout << " Opción inválida. Intente nuevamente.\n";
                 pausar();
         }
         
     } while (opcion != 8); // Repetir hasta elegir salir
     
     // Limpieza final de memoria
-    if (raiz != NULL) {
-        eliminarArbol(raiz);
-    }
+    if (registroActivo) cerrarRegistro(registro);
+    limpiarArbolCompleto(raiz);
     
     return 0;
 }
-